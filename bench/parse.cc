@@ -0,0 +1,133 @@
+// Throughput of the integer parsers in aoc/parse.h against the std::stoull on
+// a std::string path the readers used to take. The buffer of random numbers is
+// split into fields up front so only the conversion itself is timed, and the
+// sums are compared so the optimizer can't throw any of the work away.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aoc/input.h"
+#include "aoc/parse.h"
+
+std::vector<std::string_view> split_buffer(const std::string& buffer) {
+    std::vector<std::string_view> fields;
+    for (std::string_view line : aoc::lines(buffer)) {
+        fields.push_back(line);
+    }
+    return fields;
+}
+
+std::string make_buffer(size_t count, int max_digits, bool allow_negative, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> digit_dist(1, max_digits);
+    std::string buffer;
+    buffer.reserve(count * (max_digits + 2));
+    for (size_t ii=0; ii<count; ii++) {
+        int digits = digit_dist(rng);
+        if (allow_negative && (rng() & 1)) buffer.push_back('-');
+        buffer.push_back(static_cast<char>('1' + rng() % 9));
+        for (int dd=1; dd<digits; dd++) {
+            buffer.push_back(static_cast<char>('0' + rng() % 10));
+        }
+        buffer.push_back('\n');
+    }
+    return buffer;
+}
+
+struct Result {
+    double seconds;
+    uint64_t checksum;
+};
+
+template <typename F>
+Result time_parser(const std::vector<std::string_view>& fields, int repeats, F parse) {
+    Result best = {1e30, 0};
+    for (int rep=0; rep<repeats; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t checksum = 0;
+        for (std::string_view field : fields) {
+            checksum += static_cast<uint64_t>(parse(field));
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best.seconds = std::min(best.seconds, elapsed.count());
+        best.checksum = checksum;
+    }
+    return best;
+}
+
+void report(const std::string& name, const std::string& buffer, const Result& result, uint64_t expected) {
+    double mb_per_s = static_cast<double>(buffer.size()) / result.seconds / 1e6;
+    std::cout << "  " << std::left << std::setw(28) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1) << mb_per_s << " MB/s"
+              << std::setw(12) << std::setprecision(2) << result.seconds * 1e3 << " ms";
+    if (result.checksum != expected) {
+        std::cout << "  CHECKSUM MISMATCH";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv) {
+
+    size_t count = 4000000;
+    int repeats = 5;
+    if (argc > 1) count = std::strtoull(argv[1], nullptr, 10);
+    if (argc > 2) repeats = std::atoi(argv[2]);
+
+    // Unsigned 64-bit values of up to 19 digits
+    {
+        std::string buffer = make_buffer(count, 19, false, 1);
+        std::vector<std::string_view> fields = split_buffer(buffer);
+        std::cout << "uint64, " << buffer.size() << " bytes" << std::endl;
+        Result ref = time_parser(fields, repeats, [](std::string_view line) {
+            return std::stoull(std::string(line));
+        });
+        report("std::stoull(string)", buffer, ref, ref.checksum);
+        report("aoc::parse_int_fc", buffer, time_parser(fields, repeats, aoc::parse_int_fc<uint64_t>), ref.checksum);
+        report("aoc::parse_int (SWAR)", buffer, time_parser(fields, repeats, aoc::parse_int<uint64_t>), ref.checksum);
+    }
+
+    // Signed 64-bit values
+    {
+        std::string buffer = make_buffer(count, 18, true, 2);
+        std::vector<std::string_view> fields = split_buffer(buffer);
+        std::cout << "int64, " << buffer.size() << " bytes" << std::endl;
+        Result ref = time_parser(fields, repeats, [](std::string_view line) {
+            return std::stoll(std::string(line));
+        });
+        report("std::stoll(string)", buffer, ref, ref.checksum);
+        report("aoc::parse_int_fc", buffer, time_parser(fields, repeats, aoc::parse_int_fc<int64_t>), ref.checksum);
+        report("aoc::parse_int (SWAR)", buffer, time_parser(fields, repeats, aoc::parse_int<int64_t>), ref.checksum);
+    }
+
+    // Short values like the puzzle coordinates and counts
+    {
+        std::string buffer = make_buffer(count, 5, false, 3);
+        std::vector<std::string_view> fields = split_buffer(buffer);
+        std::cout << "short uint64, " << buffer.size() << " bytes" << std::endl;
+        Result ref = time_parser(fields, repeats, [](std::string_view line) {
+            return std::stoull(std::string(line));
+        });
+        report("std::stoull(string)", buffer, ref, ref.checksum);
+        report("aoc::parse_int_fc", buffer, time_parser(fields, repeats, aoc::parse_int_fc<uint64_t>), ref.checksum);
+        report("aoc::parse_int (SWAR)", buffer, time_parser(fields, repeats, aoc::parse_int<uint64_t>), ref.checksum);
+    }
+
+    // 128-bit values have no standard library equivalent, only the low 64
+    // bits go into the checksum
+    {
+        std::string buffer = make_buffer(count / 2, 38, false, 4);
+        std::vector<std::string_view> fields = split_buffer(buffer);
+        std::cout << "uint128, " << buffer.size() << " bytes" << std::endl;
+        Result swar = time_parser(fields, repeats, aoc::parse_int<aoc::uint128>);
+        report("aoc::parse_int (SWAR)", buffer, swar, swar.checksum);
+    }
+
+    return EXIT_SUCCESS;
+}
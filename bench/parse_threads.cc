@@ -0,0 +1,123 @@
+// Scaling of aoc::parallel::parallel_parse with the number of threads. A large
+// buffer of day 8 style "x,y,z" lines is parsed into points the way day 8
+// reads its input, on pools of 1, 2, 4, ... threads up to the number of cores
+// (or the thread counts given), and the throughput and speedup over the
+// first thread count are printed. A sum over the same bytes on the same pool
+// gives the memory bandwidth the parser is bounded by. Every run has to
+// produce the same points as the single piece parse.
+//
+// Usage: parse_threads [lines] [repeats] [threads...]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "aoc/input.h"
+#include "aoc/parallel.h"
+#include "aoc/parse.h"
+
+using Point3D = std::array<uint64_t, 3>;
+
+std::string make_buffer(size_t count, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::string buffer;
+    buffer.reserve(count * 20);
+    for (size_t ii=0; ii<count; ii++) {
+        buffer += std::to_string(rng() % 100000) + ',' + std::to_string(rng() % 100000) + ',' + std::to_string(rng() % 100000) + '\n';
+    }
+    return buffer;
+}
+
+bool parse_piece(std::string_view piece, std::vector<Point3D>& points) {
+    for (std::string_view line : aoc::lines(piece)) {
+        if (line.empty()) return false;
+        points.push_back(aoc::parse_fields<uint64_t, 3>(line, ','));
+    }
+    return true;
+}
+
+// Best of repeats, in seconds
+template <typename F>
+double time_best(int repeats, F run) {
+    double best = 1e30;
+    for (int rep=0; rep<repeats; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+
+    size_t count = 20000000;
+    int repeats = 5;
+    std::vector<size_t> thread_counts;
+    if (argc > 1) count = std::strtoull(argv[1], nullptr, 10);
+    if (argc > 2) repeats = std::atoi(argv[2]);
+    for (int ii=3; ii<argc; ii++) {
+        thread_counts.push_back(std::max<size_t>(1, std::strtoull(argv[ii], nullptr, 10)));
+    }
+    if (thread_counts.empty()) {
+        size_t cores = std::max<size_t>(1, std::thread::hardware_concurrency());
+        for (size_t threads=1; threads<cores; threads*=2) {
+            thread_counts.push_back(threads);
+        }
+        thread_counts.push_back(cores);
+    }
+
+    std::string buffer = make_buffer(count, 1);
+    std::vector<Point3D> expected;
+    parse_piece(buffer, expected);
+    double megabytes = static_cast<double>(buffer.size()) / 1e6;
+    std::cout << count << " lines, " << buffer.size() << " bytes, " << aoc::parallel::split_records(buffer, '\n', aoc::parallel::PARSE_GRAIN).size()
+              << " pieces of " << aoc::parallel::PARSE_GRAIN << " bytes" << std::endl;
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "parse MB/s" << std::setw(10) << "speedup"
+              << std::setw(14) << "read MB/s" << std::endl;
+
+    double single = 0;
+    size_t failures = 0;
+    for (size_t threads : thread_counts) {
+        aoc::parallel::Pool pool(threads);
+        std::vector<Point3D> points;
+        double parse = time_best(repeats, [&] {
+            points = aoc::parallel::parallel_parse<Point3D>(pool, buffer, '\n', aoc::parallel::PARSE_GRAIN, parse_piece);
+        });
+        if (points != expected) {
+            std::cout << "  MISMATCH with " << threads << " threads" << std::endl;
+            failures++;
+        }
+
+        // Every byte read once, split the same way
+        std::vector<std::string_view> pieces = aoc::parallel::split_records(buffer, '\n', aoc::parallel::PARSE_GRAIN);
+        std::vector<uint64_t> sums(pieces.size());
+        double read = time_best(repeats, [&] {
+            pool.run(pieces.size(), [&](size_t piece) {
+                uint64_t sum = 0;
+                for (size_t ii=0; ii+8<=pieces[piece].size(); ii+=8) {
+                    uint64_t word;
+                    std::memcpy(&word, pieces[piece].data() + ii, sizeof(word));
+                    sum += word;
+                }
+                sums[piece] = sum;
+            });
+        });
+
+        if (single == 0) single = parse;
+        std::cout << std::setw(8) << threads << std::fixed << std::setprecision(1)
+                  << std::setw(14) << megabytes / parse << std::setprecision(2) << std::setw(10) << single / parse
+                  << std::setprecision(1) << std::setw(14) << megabytes / read << std::endl;
+    }
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,213 @@
+// Checks the SIMD kernels in aoc/simd.h at every level this CPU supports
+// against the scalar ones, then times each level. The inputs are random and
+// sized so every vector loop also leaves a scalar tail, and any difference
+// fails the run.
+//
+// Usage: simd [size] [repeats]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "aoc/grid.h"
+#include "aoc/points.h"
+#include "aoc/simd.h"
+
+namespace simd = aoc::simd;
+
+size_t failures = 0;
+
+void expect(bool same, simd::Level level, const std::string& what) {
+    if (same) return;
+    std::cout << "  MISMATCH " << simd::level_name(level) << " " << what << std::endl;
+    failures++;
+}
+
+std::vector<uint8_t> make_digits(size_t size, std::mt19937_64& rng) {
+    std::vector<uint8_t> digits(size);
+    for (uint8_t& digit : digits) {
+        digit = static_cast<uint8_t>(rng() % 256);
+    }
+    return digits;
+}
+
+aoc::Grid<char> make_grid(size_t width, size_t height, int percent, std::mt19937_64& rng) {
+    aoc::Grid<char> grid(width, height, 1, '.');
+    for (size_t yy=0; yy<height; yy++) {
+        char* row = grid.row(static_cast<ptrdiff_t>(yy));
+        for (size_t xx=0; xx<width; xx++) {
+            if (static_cast<int>(rng() % 100) < percent) row[xx] = '@';
+        }
+    }
+    return grid;
+}
+
+// Runs remove_accessible over the grid until nothing more can be removed
+size_t remove_all(const simd::Kernels& kernels, aoc::Grid<char>& grid) {
+    size_t total = 0;
+    size_t removed = 1;
+    while (removed) {
+        removed = 0;
+        for (ptrdiff_t yy=0; yy<static_cast<ptrdiff_t>(grid.height()); yy++) {
+            removed += kernels.remove_accessible(grid.row(yy-1), grid.row(yy), grid.row(yy+1), grid.width());
+        }
+        total += removed;
+    }
+    return total;
+}
+
+size_t count_all(const simd::Kernels& kernels, const aoc::Grid<char>& grid) {
+    size_t total = 0;
+    for (ptrdiff_t yy=0; yy<static_cast<ptrdiff_t>(grid.height()); yy++) {
+        total += kernels.count_accessible(grid.row(yy-1), grid.row(yy), grid.row(yy+1), grid.width());
+    }
+    return total;
+}
+
+void check(simd::Level level, std::mt19937_64& rng) {
+    const simd::Kernels& reference = simd::kernels(simd::Level::scalar);
+    const simd::Kernels& kernels = simd::kernels(level);
+
+    for (size_t size=0; size<300; size++) {
+        std::vector<uint8_t> digits = make_digits(size, rng);
+        expect(kernels.first_max(digits.data(), size) == reference.first_max(digits.data(), size),
+               level, "first_max size " + std::to_string(size));
+    }
+
+    for (size_t width : {1, 2, 3, 15, 16, 17, 31, 32, 33, 63, 64, 65, 139, 200}) {
+        for (int percent : {20, 65, 90}) {
+            aoc::Grid<char> grid = make_grid(width, 13, percent, rng);
+            std::string name = " width " + std::to_string(width) + " fill " + std::to_string(percent);
+            expect(count_all(kernels, grid) == count_all(reference, grid), level, "count_accessible" + name);
+            aoc::Grid<char> expected = grid;
+            size_t expected_total = remove_all(reference, expected);
+            expect(remove_all(kernels, grid) == expected_total && grid == expected, level, "remove_accessible" + name);
+        }
+    }
+
+    for (size_t count=0; count<40; count++) {
+        std::vector<uint64_t> xs(count), ys(count), zs(count), out(count), expected(count);
+        for (size_t ii=0; ii<count; ii++) {
+            // Full range values, so the differences wrap and the squares overflow
+            xs[ii] = rng();
+            ys[ii] = rng() % 100000;
+            zs[ii] = rng() >> (rng() % 64);
+        }
+        uint64_t x = rng(), y = rng() % 100000, z = rng() >> 7;
+        reference.squared_distances(xs.data(), ys.data(), zs.data(), count, x, y, z, expected.data());
+        kernels.squared_distances(xs.data(), ys.data(), zs.data(), count, x, y, z, out.data());
+        expect(out == expected, level, "squared_distances count " + std::to_string(count));
+    }
+
+    for (size_t count=0; count<40; count++) {
+        std::vector<int64_t> xs(count), ys(count), out(count), expected(count);
+        for (size_t ii=0; ii<count; ii++) {
+            // Either sign, some full range so the differences and areas wrap
+            xs[ii] = static_cast<int64_t>(rng() % 200000) - 100000;
+            ys[ii] = static_cast<int64_t>(rng() >> (rng() % 64));
+        }
+        int64_t x = static_cast<int64_t>(rng() % 200000) - 100000, y = static_cast<int64_t>(rng());
+        reference.rect_areas(xs.data(), ys.data(), count, x, y, expected.data());
+        kernels.rect_areas(xs.data(), ys.data(), count, x, y, out.data());
+        expect(out == expected, level, "rect_areas count " + std::to_string(count));
+    }
+}
+
+// Best of repeats, in nanoseconds per item
+template <typename F>
+double time_kernel(int repeats, size_t items, F run) {
+    double best = 1e30;
+    for (int rep=0; rep<repeats; rep++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count() / static_cast<double>(items));
+    }
+    return best;
+}
+
+int main(int argc, char **argv) {
+
+    size_t size = 1000;
+    int repeats = 5;
+    if (argc > 1) size = std::max<size_t>(1, std::strtoull(argv[1], nullptr, 10));
+    if (argc > 2) repeats = std::atoi(argv[2]);
+
+    simd::Level supported = simd::supported_level();
+    std::cout << "Supported: " << simd::level_name(supported)
+              << ", selected: " << simd::level_name(simd::selected_level()) << std::endl;
+
+    // Every level against the scalar kernels
+    std::mt19937_64 rng(1);
+    for (size_t ii=1; ii<=static_cast<size_t>(supported); ii++) {
+        check(static_cast<simd::Level>(ii), rng);
+    }
+    if (failures > 0) {
+        std::cout << failures << " kernel result(s) differ from the scalar ones" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "All levels match the scalar kernels" << std::endl;
+
+    // Timings, a row of 100 digits like a day 3 bank, a size x size day 4
+    // grid, and the distances and areas of every pair of size points, tile
+    // by tile like days 8 and 9
+    std::vector<uint8_t> digits = make_digits(100, rng);
+    aoc::Grid<char> grid = make_grid(size, size, 65, rng);
+    std::vector<std::array<uint64_t, 3>> points3(size);
+    std::vector<std::array<int64_t, 2>> points2(size);
+    for (size_t ii=0; ii<size; ii++) {
+        points3[ii] = {rng() % 100000, rng() % 100000, rng() % 100000};
+        points2[ii] = {static_cast<int64_t>(rng() % 100000), static_cast<int64_t>(rng() % 100000)};
+    }
+    aoc::Points<uint64_t, 3> soa3(points3);
+    aoc::Points<int64_t, 2> soa2(points2);
+    std::vector<uint64_t> out(aoc::PAIR_TILE);
+    std::vector<int64_t> areas(aoc::PAIR_TILE);
+    size_t pairs = std::max<size_t>(1, aoc::pair_count(size));
+    std::cout << "\n" << std::left << std::setw(10) << "level" << std::right
+              << std::setw(18) << "first_max ns/B" << std::setw(18) << "accessible ns/B"
+              << std::setw(20) << "distances ns/pair" << std::setw(16) << "areas ns/pair" << std::endl;
+    uint64_t sink = 0;
+    for (size_t ii=0; ii<=static_cast<size_t>(supported); ii++) {
+        simd::Level level = static_cast<simd::Level>(ii);
+        const simd::Kernels& kernels = simd::kernels(level);
+        double first_max = time_kernel(repeats, 100 * 10000, [&] {
+            for (size_t rep=0; rep<10000; rep++) {
+                sink += kernels.first_max(digits.data(), digits.size());
+            }
+        });
+        double accessible = time_kernel(repeats, size * size, [&] {
+            sink += count_all(kernels, grid);
+        });
+        double distances = time_kernel(repeats, pairs, [&] {
+            const uint64_t* xs = soa3.coord(0);
+            const uint64_t* ys = soa3.coord(1);
+            const uint64_t* zs = soa3.coord(2);
+            aoc::for_each_pair_tile(size, [&](size_t pp, size_t begin, size_t end) {
+                kernels.squared_distances(xs + begin, ys + begin, zs + begin, end - begin, xs[pp], ys[pp], zs[pp], out.data());
+                sink += out[0];
+            });
+        });
+        double rects = time_kernel(repeats, pairs, [&] {
+            const int64_t* xs = soa2.coord(0);
+            const int64_t* ys = soa2.coord(1);
+            aoc::for_each_pair_tile(size, [&](size_t pp, size_t begin, size_t end) {
+                kernels.rect_areas(xs + begin, ys + begin, end - begin, xs[pp], ys[pp], areas.data());
+                sink += static_cast<uint64_t>(areas[0]);
+            });
+        });
+        std::cout << std::left << std::setw(10) << simd::level_name(level) << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(18) << first_max << std::setw(18) << accessible
+                  << std::setw(20) << distances << std::setw(16) << rects << std::endl;
+    }
+    if (sink == 42) std::cout << std::endl;
+
+    return EXIT_SUCCESS;
+}
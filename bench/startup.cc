@@ -0,0 +1,132 @@
+// Exec to exit time of day executables. Each one is started on its input
+// data/<day>/<data file> over and over, with stdout going to /dev/null, and
+// the min, median and p99 wall time from posix_spawn to waitpid are reported
+// per executable. That is everything a run from the shell pays: loading and
+// dynamic linking, static initializers, solving and writing the answers.
+// AOC_CACHE_DIR is cleared so every run solves.
+//
+// Usage: startup [-n runs] [-d data file] [-o json] <executable>...
+// e.g. startup -n 200 output/release/day1 output/lean/day1
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char **environ;
+
+struct Result {
+    std::string config;
+    std::string day;
+    size_t runs;
+    int64_t min_ns;
+    int64_t median_ns;
+    int64_t p99_ns;
+};
+
+// Wall time of one run in nanoseconds, or -1 if it could not be started or
+// did not exit successfully
+int64_t time_run(const std::string& executable, const std::string& input, const posix_spawn_file_actions_t& actions) {
+    std::vector<char*> argv = {const_cast<char*>(executable.c_str()), const_cast<char*>(input.c_str()), nullptr};
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid;
+    if (posix_spawn(&pid, executable.c_str(), &actions, nullptr, argv.data(), environ) != 0) return -1;
+    int status;
+    if (waitpid(pid, &status, 0) != pid) return -1;
+    std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) return -1;
+    return elapsed.count();
+}
+
+int main(int argc, char **argv) {
+
+    size_t runs = 200;
+    std::string data = "input.dat";
+    std::string json_path;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:d:o:")) != -1) {
+        switch (opt) {
+            case 'n': runs = std::max<size_t>(1, std::strtoull(optarg, nullptr, 10)); break;
+            case 'd': data = optarg; break;
+            case 'o': json_path = optarg; break;
+            default:
+                std::cout << "Usage: " << argv[0] << " [-n runs] [-d data file] [-o json] <executable>..." << std::endl;
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind == argc) {
+        std::cout << "Usage: " << argv[0] << " [-n runs] [-d data file] [-o json] <executable>..." << std::endl;
+        return EXIT_FAILURE;
+    }
+    unsetenv("AOC_CACHE_DIR");
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+
+    std::cout << std::left << std::setw(12) << "config" << std::setw(8) << "day" << std::right
+              << std::setw(8) << "runs" << std::setw(12) << "min us" << std::setw(12) << "median us"
+              << std::setw(12) << "p99 us" << std::endl;
+    std::vector<Result> results;
+    for (int ii=optind; ii<argc; ii++) {
+        std::filesystem::path executable = argv[ii];
+        std::string day = executable.filename().string();
+        std::string input = "data/" + day + "/" + data;
+        if (!std::filesystem::exists(input)) {
+            std::cout << "Skipping " << executable.string() << ", no " << input << std::endl;
+            continue;
+        }
+
+        // A few runs first to get the executable and its input into the page cache
+        std::vector<int64_t> samples;
+        for (size_t run=0; run<runs+5; run++) {
+            int64_t ns = time_run(executable.string(), input, actions);
+            if (ns < 0) {
+                std::cout << executable.string() << " " << input << " failed" << std::endl;
+                return EXIT_FAILURE;
+            }
+            if (run >= 5) samples.push_back(ns);
+        }
+        std::sort(samples.begin(), samples.end());
+        size_t n = samples.size();
+        Result result = {
+            .config = executable.parent_path().filename().string(),
+            .day = day,
+            .runs = n,
+            .min_ns = samples.front(),
+            .median_ns = samples[n / 2],
+            .p99_ns = samples[std::min(n - 1, (n * 99 + 99) / 100 - 1)],
+        };
+        std::cout << std::left << std::setw(12) << result.config << std::setw(8) << result.day << std::right
+                  << std::setw(8) << result.runs << std::fixed << std::setprecision(1)
+                  << std::setw(12) << static_cast<double>(result.min_ns) / 1e3
+                  << std::setw(12) << static_cast<double>(result.median_ns) / 1e3
+                  << std::setw(12) << static_cast<double>(result.p99_ns) / 1e3 << std::endl;
+        results.push_back(result);
+    }
+    posix_spawn_file_actions_destroy(&actions);
+
+    if (!json_path.empty()) {
+        std::ofstream ofile(json_path);
+        ofile << "[";
+        for (size_t ii=0; ii<results.size(); ii++) {
+            const Result& result = results[ii];
+            ofile << (ii ? ", " : "") << "{\"config\": \"" << result.config << "\", \"day\": \"" << result.day
+                  << "\", \"runs\": " << result.runs << ", \"min_ns\": " << result.min_ns
+                  << ", \"median_ns\": " << result.median_ns << ", \"p99_ns\": " << result.p99_ns << "}";
+        }
+        ofile << "]\n";
+    }
+
+    return EXIT_SUCCESS;
+}
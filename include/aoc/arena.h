@@ -0,0 +1,93 @@
+// Per-run arena for std::pmr containers
+//
+// An Arena stacks a pool resource on a monotonic buffer. Containers built on
+// arena.resource() get their small blocks from the pools, so the many tiny
+// vectors and sets a solver churns through are recycled instead of going back
+// to the global heap, and the pools themselves are carved out of a few large
+// buffers. Everything is handed back in one go when the arena is destroyed,
+// so an arena should live for one call of a solver (or the parse results it
+// owns), never for the whole program.
+//
+// Both ends of the arena are counted: what the containers asked for, which is
+// what they would have cost on the global heap, and what actually came from
+// the system. In trace builds the totals are added to the AOC_TRACE_JSON
+// report as <name>/requested_* and <name>/system_* counters.
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <utility>
+
+#include "aoc/trace.h"
+
+namespace aoc {
+
+// Passes everything through to upstream and counts the allocations
+class CountingResource : public std::pmr::memory_resource {
+public:
+    explicit CountingResource(std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+    size_t allocations() const { return allocations_; }
+    size_t bytes() const { return bytes_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        allocations_++;
+        bytes_ += bytes;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    std::pmr::memory_resource* upstream_;
+    size_t allocations_ = 0;
+    size_t bytes_ = 0;
+};
+
+class Arena {
+public:
+    // Blocks up to largest_pooled bytes are recycled through the pools, bigger
+    // ones come straight from the monotonic buffer and are only reclaimed
+    // when the arena goes away
+    explicit Arena(std::string name, size_t initial_size = 64 * 1024, size_t largest_pooled = 1 << 20)
+        : name_(std::move(name)),
+          buffer_(initial_size, &system_),
+          pool_(std::pmr::pool_options{.max_blocks_per_chunk = 0, .largest_required_pool_block = largest_pooled}, &buffer_) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        if constexpr (trace::enabled) {
+            trace::Registry& registry = trace::Registry::get();
+            registry.counter(name_ + "/requested_allocations").add(requested_.allocations());
+            registry.counter(name_ + "/requested_bytes").add(requested_.bytes());
+            registry.counter(name_ + "/system_allocations").add(system_.allocations());
+            registry.counter(name_ + "/system_bytes").add(system_.bytes());
+        }
+    }
+
+    std::pmr::memory_resource* resource() { return &requested_; }
+
+    // What the containers asked for
+    const CountingResource& requested() const { return requested_; }
+
+    // What the arena took from the global heap
+    const CountingResource& system() const { return system_; }
+
+private:
+    std::string name_;
+    CountingResource system_{std::pmr::new_delete_resource()};
+    std::pmr::monotonic_buffer_resource buffer_;
+    std::pmr::unsynchronized_pool_resource pool_;
+    CountingResource requested_{&pool_};
+};
+
+} // namespace aoc
@@ -0,0 +1,352 @@
+// In-process benchmark harness
+//
+// Each day's main wraps its parse and solve calls in Harness::phase. In a
+// normal build a phase is just a direct call. When built with -DAOC_BENCH
+// (make bench) every phase is run a few times to warm up, then timed
+// repeatedly, and the min / median / p99 of the per-call wall time in
+// nanoseconds is reported as a table on stdout and optionally as JSON.
+//
+// Bench builds are tuned through the environment:
+//   AOC_BENCH_WARMUP       untimed calls before measuring (default 3)
+//   AOC_BENCH_MIN_ITERS    minimum timed calls per phase (default 5)
+//   AOC_BENCH_MAX_ITERS    maximum timed calls per phase (default 10000)
+//   AOC_BENCH_MIN_TIME_MS  keep timing until this much time is spent (default 1000)
+//   AOC_BENCH_JSON         write the JSON report to this file
+//   AOC_BENCH_PERF         0 to skip the hardware counters
+//
+// Where perf_event_open is allowed, the timed calls of each phase are also
+// counted with the hardware counters in aoc/perf.h, and cycles, instructions,
+// IPC, L1D and LLC misses and branch misses per call are reported with them.
+//
+// A phase can also be given the number of items it handles per call with
+// Harness::items, and is then reported with its rate in items per second.
+//
+// Builds with -DAOC_MEMSTATS also record the allocations and peak memory of
+// each phase (see aoc/memstats.h), which go in the same table and JSON.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aoc/memstats.h"
+#include "aoc/output.h"
+#include "aoc/parallel.h"
+#include "aoc/perf.h"
+#include "aoc/simd.h"
+
+namespace aoc::bench {
+
+#ifdef AOC_BENCH
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+// Keeps the compiler from discarding a result that is otherwise unused
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct Options {
+    size_t warmup = 3;
+    size_t min_iterations = 5;
+    size_t max_iterations = 10000;
+    int64_t min_time_ns = 1000000000;
+    std::string json_path;
+
+    static Options from_env() {
+        Options options;
+        if (const char* value = std::getenv("AOC_BENCH_WARMUP")) {
+            options.warmup = std::strtoull(value, nullptr, 10);
+        }
+        if (const char* value = std::getenv("AOC_BENCH_MIN_ITERS")) {
+            options.min_iterations = std::max<size_t>(1, std::strtoull(value, nullptr, 10));
+        }
+        if (const char* value = std::getenv("AOC_BENCH_MAX_ITERS")) {
+            options.max_iterations = std::max<size_t>(1, std::strtoull(value, nullptr, 10));
+        }
+        if (const char* value = std::getenv("AOC_BENCH_MIN_TIME_MS")) {
+            options.min_time_ns = std::strtoll(value, nullptr, 10) * 1000000;
+        }
+        if (const char* value = std::getenv("AOC_BENCH_JSON")) {
+            options.json_path = value;
+        }
+        return options;
+    }
+};
+
+struct PhaseStats {
+    std::string name;
+    size_t iterations;
+    int64_t min_ns;
+    int64_t median_ns;
+    int64_t p99_ns;
+    perf::Reading counters;
+    // Work done per call, see Harness::items
+    size_t items;
+    std::string unit;
+};
+
+// Summarizes a set of per-call samples, which get sorted in place
+inline PhaseStats summarize(std::string name, std::vector<int64_t>& samples) {
+    std::sort(samples.begin(), samples.end());
+    size_t n = samples.size();
+    size_t p99_idx = (n * 99 + 99) / 100 - 1;
+    int64_t median = (n & 1) ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    return {
+        .name = std::move(name),
+        .iterations = n,
+        .min_ns = samples.front(),
+        .median_ns = median,
+        .p99_ns = samples[std::min(p99_idx, n - 1)],
+        .counters = {},
+        .items = 0,
+        .unit = {},
+    };
+}
+
+class Harness {
+public:
+    Harness(std::string day, std::string input)
+        : day_(std::move(day)), input_(std::move(input)) {
+        if constexpr (enabled || memstats::enabled) {
+            options_ = Options::from_env();
+        }
+        if constexpr (enabled) {
+            counters_ = std::make_unique<perf::Counters>();
+        }
+    }
+
+    // Runs fn and returns its result. In bench builds fn is also called
+    // repeatedly first, so it must be safe to call more than once. Memory is
+    // measured over the last call only.
+    template <typename F>
+    decltype(auto) phase(const char* name, F&& fn) {
+        if constexpr (enabled) {
+            measure(name, fn);
+        }
+        if constexpr (memstats::enabled) {
+            memstats::Probe probe(name, memory_);
+            return fn();
+        }
+        else {
+            return fn();
+        }
+    }
+
+    // Records that every call of the last phase handles count items of unit,
+    // e.g. pairs of points, which the report turns into a rate at the median
+    // time. Does nothing in normal builds.
+    void items(const char* unit, size_t count) {
+        if constexpr (enabled) {
+            if (results_.empty()) return;
+            results_.back().items = count;
+            results_.back().unit = unit;
+        }
+    }
+
+    const std::vector<PhaseStats>& results() const { return results_; }
+    const std::vector<memstats::PhaseMemory>& memory() const { return memory_; }
+
+    // Prints the table and writes the JSON file, does nothing in normal builds
+    void report() const {
+        if constexpr (enabled || memstats::enabled) {
+            std::ostringstream text;
+            write_text(text);
+            print(text.str());
+            if (!options_.json_path.empty()) {
+                std::ofstream ofile(options_.json_path);
+                write_json(ofile);
+            }
+        }
+    }
+
+    void write_text(std::ostream& out) const {
+        out << "\n" << day_ << " (" << input_ << ")\n";
+        out << "  " << std::left << std::setw(30) << "phase"
+            << std::right << std::setw(8) << "iters"
+            << std::setw(16) << "min ns"
+            << std::setw(16) << "median ns"
+            << std::setw(16) << "p99 ns" << "\n";
+        for (const PhaseStats& stats : results_) {
+            out << "  " << std::left << std::setw(30) << stats.name
+                << std::right << std::setw(8) << stats.iterations
+                << std::setw(16) << stats.min_ns
+                << std::setw(16) << stats.median_ns
+                << std::setw(16) << stats.p99_ns << "\n";
+        }
+        for (const PhaseStats& stats : results_) {
+            if (stats.items == 0) continue;
+            std::streamsize precision = out.precision();
+            out << "  " << std::left << std::setw(30) << stats.name << std::right
+                << std::setw(16) << stats.items << " " << stats.unit << ", "
+                << std::fixed << std::setprecision(1) << rate(stats) / 1e6 << " M " << stats.unit << "/s\n";
+            out.unsetf(std::ios::floatfield);
+            out.precision(precision);
+        }
+        if (counters_ && counters_->available()) {
+            std::streamsize precision = out.precision();
+            out << "  " << std::left << std::setw(30) << "phase (per call)"
+                << std::right << std::setw(16) << "cycles"
+                << std::setw(16) << "instructions"
+                << std::setw(8) << "IPC"
+                << std::setw(14) << "L1D misses"
+                << std::setw(14) << "LLC misses"
+                << std::setw(14) << "br misses" << "\n";
+            for (const PhaseStats& stats : results_) {
+                auto cell = [&](perf::Counter counter, int width) {
+                    out << std::setw(width);
+                    if (stats.counters.valid[counter]) out << per_call(stats, counter);
+                    else out << "-";
+                };
+                out << "  " << std::left << std::setw(30) << stats.name << std::right << std::fixed << std::setprecision(0);
+                cell(perf::cycles, 16);
+                cell(perf::instructions, 16);
+                out << std::setw(8) << std::setprecision(2);
+                if (stats.counters.valid[perf::cycles] && stats.counters.valid[perf::instructions]) out << ipc(stats);
+                else out << "-";
+                out << std::setprecision(0);
+                cell(perf::l1d_misses, 14);
+                cell(perf::llc_misses, 14);
+                cell(perf::branch_misses, 14);
+                out << "\n";
+            }
+            out.unsetf(std::ios::floatfield);
+            out.precision(precision);
+        }
+        else if (counters_) {
+            out << "  (hardware counters unavailable, timings only)\n";
+        }
+        if (!memory_.empty()) {
+            out << "  " << std::left << std::setw(30) << "phase"
+                << std::right << std::setw(12) << "allocs"
+                << std::setw(16) << "alloc bytes"
+                << std::setw(16) << "peak live"
+                << std::setw(16) << "peak rss kB" << "\n";
+            for (const memstats::PhaseMemory& stats : memory_) {
+                out << "  " << std::left << std::setw(30) << stats.name
+                    << std::right << std::setw(12) << stats.allocations
+                    << std::setw(16) << stats.allocated_bytes
+                    << std::setw(16) << stats.peak_live_bytes
+                    << std::setw(16) << stats.peak_rss_kb << "\n";
+            }
+        }
+        out << std::flush;
+    }
+
+    void write_json(std::ostream& out) const {
+        out << "{\"day\": \"" << day_ << "\", \"input\": \"" << input_ << "\""
+            << ", \"threads\": " << parallel::default_threads()
+            << ", \"simd\": \"" << simd::level_name(simd::selected_level()) << "\"" << ", \"phases\": [";
+        for (size_t ii=0; ii<results_.size(); ii++) {
+            const PhaseStats& stats = results_[ii];
+            out << (ii ? ", " : "")
+                << "{\"name\": \"" << stats.name << "\""
+                << ", \"iterations\": " << stats.iterations
+                << ", \"min_ns\": " << stats.min_ns
+                << ", \"median_ns\": " << stats.median_ns
+                << ", \"p99_ns\": " << stats.p99_ns;
+            if (stats.items) {
+                out << ", \"items\": " << stats.items << ", \"unit\": \"" << stats.unit << "\""
+                    << ", \"items_per_second\": " << rate(stats);
+            }
+            // Per call, only the counters that could be read
+            bool any = false;
+            for (size_t counter=0; counter<perf::COUNTER_COUNT; counter++) {
+                if (!stats.counters.valid[counter]) continue;
+                out << (any ? ", \"" : ", \"counters\": {\"") << perf::counter_names[counter] << "\": "
+                    << per_call(stats, static_cast<perf::Counter>(counter));
+                any = true;
+            }
+            if (stats.counters.valid[perf::cycles] && stats.counters.valid[perf::instructions]) {
+                out << ", \"ipc\": " << ipc(stats);
+            }
+            out << (any ? "}}" : "}");
+        }
+        out << "]";
+        if (!memory_.empty()) {
+            // Keyed by "phase" rather than "name" so bench_check skips them
+            out << ", \"memory\": [";
+            for (size_t ii=0; ii<memory_.size(); ii++) {
+                const memstats::PhaseMemory& stats = memory_[ii];
+                out << (ii ? ", " : "")
+                    << "{\"phase\": \"" << stats.name << "\""
+                    << ", \"allocations\": " << stats.allocations
+                    << ", \"allocated_bytes\": " << stats.allocated_bytes
+                    << ", \"peak_live_bytes\": " << stats.peak_live_bytes
+                    << ", \"peak_rss_kb\": " << stats.peak_rss_kb << "}";
+            }
+            out << "]";
+        }
+        out << "}\n";
+    }
+
+private:
+    template <typename F>
+    void measure(const char* name, F& fn) {
+        using Clock = std::chrono::steady_clock;
+        for (size_t ii=0; ii<options_.warmup; ii++) {
+            call(fn);
+        }
+        std::vector<int64_t> samples;
+        int64_t total_ns = 0;
+        if (counters_) counters_->start();
+        while (samples.size() < options_.max_iterations &&
+               (samples.size() < options_.min_iterations || total_ns < options_.min_time_ns)) {
+            Clock::time_point start = Clock::now();
+            call(fn);
+            int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            samples.push_back(elapsed);
+            total_ns += elapsed;
+        }
+        perf::Reading counters;
+        if (counters_) counters = counters_->stop();
+        results_.push_back(summarize(name, samples));
+        results_.back().counters = counters;
+    }
+
+    template <typename F>
+    static void call(F& fn) {
+        if constexpr (std::is_void_v<decltype(fn())>) {
+            fn();
+        }
+        else {
+            auto result = fn();
+            do_not_optimize(result);
+        }
+    }
+
+    std::string day_;
+    std::string input_;
+    Options options_;
+    static double per_call(const PhaseStats& stats, perf::Counter counter) {
+        return static_cast<double>(stats.counters.values[counter]) / static_cast<double>(stats.iterations);
+    }
+
+    // Items per second at the median time
+    static double rate(const PhaseStats& stats) {
+        return stats.median_ns > 0 ? static_cast<double>(stats.items) * 1e9 / static_cast<double>(stats.median_ns) : 0.0;
+    }
+
+    static double ipc(const PhaseStats& stats) {
+        uint64_t cycles = stats.counters.values[perf::cycles];
+        return cycles ? static_cast<double>(stats.counters.values[perf::instructions]) / static_cast<double>(cycles) : 0.0;
+    }
+
+    std::vector<PhaseStats> results_;
+    std::vector<memstats::PhaseMemory> memory_;
+    std::unique_ptr<perf::Counters> counters_;
+};
+
+} // namespace aoc::bench
@@ -0,0 +1,190 @@
+// Pre-parsed binary inputs
+//
+// A day whose input is worth keeping parsed can write its Input out as a
+// binary file (tools/aoc_compile.cc, make compile) and load it back with no
+// parsing and no per-record work. The file is a header, a table of sections
+// and the sections, each a flat array of a trivially copyable type starting
+// on a 64 byte boundary:
+//
+//     Header        magic "AOCBIN01", day, the day's format version, the
+//                   number of sections, the payload size and its checksum
+//     Section[n]    offset from the start of the file and size in bytes
+//     payload       the arrays
+//
+// Loading checks the header and the checksum, then hands out each section as
+// a std::span straight into the bytes, which, like the text of a text input,
+// have to outlive the Input built from them. A day bumps its format version
+// whenever the layout of its sections changes, so an old file is refused
+// rather than misread.
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "aoc/cache.h"
+
+namespace aoc::binary {
+
+constexpr uint64_t MAGIC = 0x31304e4942434f41ull; // "AOCBIN01"
+constexpr size_t ALIGNMENT = 64;
+
+struct Header {
+    uint64_t magic;
+    uint32_t day;
+    uint32_t version;
+    uint64_t section_count;
+    uint64_t payload_size;
+    uint64_t checksum;
+};
+
+struct Section {
+    uint64_t offset;
+    uint64_t size;
+};
+
+// Sections start on multiples of ALIGNMENT
+inline size_t align(size_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+// Whether bytes look like a binary input rather than text
+inline bool is_binary(std::string_view bytes) {
+    uint64_t magic;
+    if (bytes.size() < sizeof(magic)) return false;
+    std::memcpy(&magic, bytes.data(), sizeof(magic));
+    return magic == MAGIC;
+}
+
+// Collects the sections of a file in order
+class Writer {
+public:
+    template <typename T>
+    void add(std::span<const T> values) {
+        static_assert(std::is_trivially_copyable_v<T>, "sections are stored as raw bytes");
+        sections_.emplace_back(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+    }
+
+    template <typename T>
+    void add(const std::vector<T>& values) {
+        add(std::span<const T>(values));
+    }
+
+    std::string finish(uint32_t day, uint32_t version) const {
+        size_t table_end = sizeof(Header) + sections_.size() * sizeof(Section);
+        size_t payload_start = align(table_end);
+        std::vector<Section> table;
+        size_t offset = payload_start;
+        for (const std::string& section : sections_) {
+            table.push_back({offset, section.size()});
+            offset = align(offset + section.size());
+        }
+
+        std::string bytes(offset, '\0');
+        for (size_t ii=0; ii<sections_.size(); ii++) {
+            std::memcpy(bytes.data() + table[ii].offset, sections_[ii].data(), sections_[ii].size());
+        }
+        if (!table.empty()) {
+            std::memcpy(bytes.data() + sizeof(Header), table.data(), table.size() * sizeof(Section));
+        }
+        std::string_view payload = std::string_view(bytes).substr(payload_start);
+        Header header = {
+            .magic = MAGIC,
+            .day = day,
+            .version = version,
+            .section_count = sections_.size(),
+            .payload_size = payload.size(),
+            .checksum = cache::hash_bytes(payload),
+        };
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        return bytes;
+    }
+
+private:
+    std::vector<std::string> sections_;
+};
+
+// Checks a file and hands out its sections. Throws std::runtime_error for a
+// file of another day or version, a truncated one or a bad checksum.
+class Reader {
+public:
+    Reader(std::string_view bytes, uint32_t day, uint32_t version) : bytes_(bytes) {
+        if (!is_binary(bytes) || bytes.size() < sizeof(Header)) fail("not a binary input");
+        std::memcpy(&header_, bytes.data(), sizeof(header_));
+        if (header_.day != day) {
+            fail("compiled for day " + std::to_string(header_.day) + ", not day " + std::to_string(day));
+        }
+        if (header_.version != version) {
+            fail("format version " + std::to_string(header_.version) + ", expected " + std::to_string(version) + ", recompile it");
+        }
+        if (header_.section_count > bytes.size() / sizeof(Section)) fail("truncated");
+        size_t payload_start = align(sizeof(Header) + header_.section_count * sizeof(Section));
+        if (payload_start > bytes.size() || bytes.size() - payload_start != header_.payload_size) fail("truncated");
+        std::string_view payload = bytes.substr(payload_start);
+        if (cache::hash_bytes(payload) != header_.checksum) fail("checksum mismatch");
+    }
+
+    size_t section_count() const { return header_.section_count; }
+
+    // Section index as an array of T, straight from the bytes
+    template <typename T>
+    std::span<const T> section(size_t index) const {
+        static_assert(std::is_trivially_copyable_v<T>, "sections are stored as raw bytes");
+        if (index >= header_.section_count) fail("missing section " + std::to_string(index));
+        Section entry;
+        std::memcpy(&entry, bytes_.data() + sizeof(Header) + index * sizeof(Section), sizeof(entry));
+        if (entry.offset > bytes_.size() || entry.size > bytes_.size() - entry.offset || entry.size % sizeof(T) != 0) {
+            fail("bad section " + std::to_string(index));
+        }
+        const char* data = bytes_.data() + entry.offset;
+        if (reinterpret_cast<uintptr_t>(data) % alignof(T) != 0) {
+            fail("section " + std::to_string(index) + " is misaligned in memory");
+        }
+        return {reinterpret_cast<const T*>(data), entry.size / sizeof(T)};
+    }
+
+private:
+    [[noreturn]] static void fail(const std::string& why) {
+        throw std::runtime_error("binary input: " + why);
+    }
+
+    std::string_view bytes_;
+    Header header_;
+};
+
+// A read-only array that owns its elements when parsed from text and is a
+// view into the bytes when loaded from a binary input. Moving it keeps the
+// view valid, copying is not allowed.
+template <typename T>
+class Array {
+public:
+    Array() = default;
+    explicit Array(std::vector<T> owned) : owned_(std::move(owned)), view_(owned_) {}
+    explicit Array(std::span<const T> view) : view_(view) {}
+
+    Array(Array&&) noexcept = default;
+    Array& operator=(Array&&) noexcept = default;
+    Array(const Array&) = delete;
+    Array& operator=(const Array&) = delete;
+
+    size_t size() const { return view_.size(); }
+    bool empty() const { return view_.empty(); }
+    const T& operator[](size_t index) const { return view_[index]; }
+    const T* data() const { return view_.data(); }
+    auto begin() const { return view_.begin(); }
+    auto end() const { return view_.end(); }
+    std::span<const T> span() const { return view_; }
+    operator std::span<const T>() const { return view_; }
+
+private:
+    std::vector<T> owned_;
+    std::span<const T> view_;
+};
+
+} // namespace aoc::binary
@@ -0,0 +1,273 @@
+// Content addressed on-disk cache for answers and intermediate results
+//
+// Entries are keyed by a hash of the input bytes, so an unchanged input is
+// never solved twice. Two kinds of entry are stored:
+//
+//   answers    keyed by day, input hash and the executable's build ID, so any
+//              rebuild invalidates them. See aoc::solve_cached in day.h.
+//   artifacts  vectors of trivially copyable values a day produces on the way
+//              to its answers, e.g. day 8's sorted distance list. They are
+//              keyed by day, input hash, artifact name and a version the day
+//              bumps whenever the code producing the artifact changes, so they
+//              survive rebuilds that only touch the later stages.
+//
+// Every file carries a checksum of its payload, and one that fails to verify
+// is deleted and treated as a miss. Hits refresh the file's modification time,
+// and after each store the oldest files are removed until the directory fits
+// in the size limit.
+//
+// The cache is off unless AOC_CACHE_DIR is set:
+//   AOC_CACHE_DIR      directory holding the cache
+//   AOC_CACHE_MAX_MB   size limit of the directory (default 256)
+//   AOC_CACHE_REFRESH  when set, ignore existing entries and overwrite them
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <elf.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <link.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <unistd.h>
+#include <vector>
+
+#include "aoc/input.h"
+#include "aoc/parse.h"
+
+namespace aoc::cache {
+
+// Multiply and fold, the mixing step of wyhash
+inline uint64_t mix(uint64_t a, uint64_t b) {
+    uint128 product = static_cast<uint128>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+}
+
+// Fast non-cryptographic 64-bit hash, one multiply per 8 bytes
+inline uint64_t hash_bytes(std::string_view data, uint64_t seed = 0) {
+    const uint64_t k0 = 0xa0761d6478bd642full;
+    const uint64_t k1 = 0xe7037ed1a0b428dbull;
+    uint64_t hash = seed ^ k0;
+    size_t ii = 0;
+    for (; ii+8<=data.size(); ii+=8) {
+        uint64_t word;
+        std::memcpy(&word, data.data() + ii, 8);
+        hash = mix(hash ^ word, k1);
+    }
+    uint64_t tail = 0;
+    if (ii < data.size()) std::memcpy(&tail, data.data() + ii, data.size() - ii);
+    hash = mix(hash ^ tail, k1 ^ data.size());
+    return mix(hash, k0);
+}
+
+inline std::string to_hex(uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+// The GNU build ID of the running executable, folded to 64 bits. Without one
+// the executable's bytes are hashed instead.
+inline uint64_t build_id() {
+    static const uint64_t id = [] {
+        std::string note;
+        dl_iterate_phdr([](dl_phdr_info* info, size_t, void* data) {
+            // The main program comes first
+            std::string& found = *static_cast<std::string*>(data);
+            for (ElfW(Half) ii=0; ii<info->dlpi_phnum; ii++) {
+                const ElfW(Phdr)& phdr = info->dlpi_phdr[ii];
+                if (phdr.p_type != PT_NOTE) continue;
+                const char* pos = reinterpret_cast<const char*>(info->dlpi_addr + phdr.p_vaddr);
+                const char* end = pos + phdr.p_memsz;
+                while (pos + sizeof(ElfW(Nhdr)) <= end) {
+                    const ElfW(Nhdr)* nhdr = reinterpret_cast<const ElfW(Nhdr)*>(pos);
+                    const char* name = pos + sizeof(ElfW(Nhdr));
+                    const char* desc = name + ((nhdr->n_namesz + 3) & ~3u);
+                    if (nhdr->n_type == NT_GNU_BUILD_ID && nhdr->n_namesz == 4 && std::memcmp(name, "GNU", 4) == 0) {
+                        found.assign(desc, nhdr->n_descsz);
+                        return 1;
+                    }
+                    pos = desc + ((nhdr->n_descsz + 3) & ~3u);
+                }
+            }
+            return 1;
+        }, &note);
+        if (!note.empty()) return hash_bytes(note);
+        MappedFile exe("/proc/self/exe");
+        return hash_bytes(exe.view());
+    }();
+    return id;
+}
+
+struct Options {
+    std::string dir;
+    uint64_t max_bytes = 256ull << 20;
+    bool refresh = false;
+
+    static Options from_env() {
+        Options options;
+        if (const char* value = std::getenv("AOC_CACHE_DIR")) {
+            options.dir = value;
+        }
+        if (const char* value = std::getenv("AOC_CACHE_MAX_MB")) {
+            options.max_bytes = std::strtoull(value, nullptr, 10) << 20;
+        }
+        options.refresh = std::getenv("AOC_CACHE_REFRESH") != nullptr;
+        return options;
+    }
+};
+
+class Cache {
+public:
+    explicit Cache(Options options = Options::from_env()) : options_(std::move(options)) {}
+
+    bool enabled() const { return !options_.dir.empty(); }
+    const Options& options() const { return options_; }
+
+    // Returns the payload stored under name, if there is a valid one
+    std::optional<std::string> load(const std::string& name) const {
+        if (!enabled() || options_.refresh) return std::nullopt;
+        std::filesystem::path path = std::filesystem::path(options_.dir) / name;
+        std::ifstream ifile(path, std::ios::binary);
+        if (!ifile) return std::nullopt;
+        std::string contents((std::istreambuf_iterator<char>(ifile)), std::istreambuf_iterator<char>());
+        ifile.close();
+
+        Header header;
+        if (contents.size() < sizeof(header)) return discard(path);
+        std::memcpy(&header, contents.data(), sizeof(header));
+        std::string_view payload = std::string_view(contents).substr(sizeof(header));
+        if (header.magic != MAGIC || header.size != payload.size() || header.checksum != hash_bytes(payload)) {
+            return discard(path);
+        }
+        std::error_code err;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), err);
+        return std::string(payload);
+    }
+
+    // Writes the payload under name, then trims the cache to its size limit.
+    // Failures are ignored, a cache that cannot be written just misses.
+    void store(const std::string& name, std::string_view payload) const {
+        if (!enabled()) return;
+        std::error_code err;
+        std::filesystem::create_directories(options_.dir, err);
+        std::filesystem::path path = std::filesystem::path(options_.dir) / name;
+        std::filesystem::path tmp = path;
+        tmp += ".tmp" + std::to_string(getpid()) + "-" + to_hex(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        {
+            Header header = {MAGIC, payload.size(), hash_bytes(payload)};
+            std::ofstream ofile(tmp, std::ios::binary);
+            ofile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            ofile.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+            if (!ofile) {
+                std::filesystem::remove(tmp, err);
+                return;
+            }
+        }
+        // Rename so concurrent readers never see a partial file
+        std::filesystem::rename(tmp, path, err);
+        trim();
+    }
+
+    // Removes files, oldest first, until the directory fits in max_bytes
+    void trim() const {
+        std::error_code err;
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+        uint64_t total = 0;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(options_.dir, err)) {
+            if (!entry.is_regular_file(err)) continue;
+            total += entry.file_size(err);
+            files.emplace_back(entry.last_write_time(err), entry.path());
+        }
+        if (total <= options_.max_bytes) return;
+        std::sort(files.begin(), files.end());
+        for (const auto& [time, path] : files) {
+            if (total <= options_.max_bytes) break;
+            total -= std::filesystem::file_size(path, err);
+            std::filesystem::remove(path, err);
+        }
+    }
+
+    // Removes every entry
+    void clear() const {
+        if (!enabled()) return;
+        std::error_code err;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(options_.dir, err)) {
+            std::filesystem::remove(entry.path(), err);
+        }
+    }
+
+private:
+    static constexpr uint64_t MAGIC = 0x3130454843414f41ull; // "AOACHE01"
+
+    struct Header {
+        uint64_t magic;
+        uint64_t size;
+        uint64_t checksum;
+    };
+
+    static std::optional<std::string> discard(const std::filesystem::path& path) {
+        std::error_code err;
+        std::filesystem::remove(path, err);
+        return std::nullopt;
+    }
+
+    Options options_;
+};
+
+// The cache and input a day is being solved against, for artifact lookups.
+// Set for the duration of aoc::solve_cached on the solving thread.
+struct Context {
+    const Cache* cache;
+    std::string day;
+    uint64_t input_hash;
+};
+
+inline thread_local const Context* current_context = nullptr;
+
+class Scope {
+public:
+    explicit Scope(const Context& context) : prev_(current_context) { current_context = &context; }
+    ~Scope() { current_context = prev_; }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const Context* prev_;
+};
+
+// Returns the cached vector named name if there is one for the current input
+// and version, otherwise computes it and stores it. Outside solve_cached, or
+// with the cache off, this is just compute().
+template <typename T, typename F>
+std::vector<T> artifact(const char* name, int version, F&& compute) {
+    static_assert(std::is_trivially_copyable_v<T>, "artifacts are stored as raw bytes");
+    const Context* context = current_context;
+    if (context == nullptr || !context->cache->enabled()) {
+        return compute();
+    }
+    std::string key = context->day + "-" + to_hex(context->input_hash) + "-" + name + "-v" + std::to_string(version) + ".art";
+    if (std::optional<std::string> payload = context->cache->load(key)) {
+        if (payload->size() % sizeof(T) == 0) {
+            std::vector<T> values(payload->size() / sizeof(T));
+            if (!values.empty()) std::memcpy(values.data(), payload->data(), payload->size());
+            return values;
+        }
+    }
+    std::vector<T> values = compute();
+    context->cache->store(key, std::string_view(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T)));
+    return values;
+}
+
+} // namespace aoc::cache
@@ -0,0 +1,470 @@
+// Interface shared by all of the days
+//
+// Each day lives in its own namespace (day1 ... day12) and defines a Solver
+//
+//     struct Solver {
+//         using Input = ...;
+//         static Input parse(std::string_view text, aoc::bench::Harness& bench);
+//         static R1 part1(Input& input, aoc::bench::Harness& bench);
+//         static R2 part2(Input& input, aoc::bench::Harness& bench);
+//     };
+//
+// parse builds everything the parts need from the raw input, which has to
+// outlive the parsed Input. The parts run in order, and part1 may leave work
+// in the input for part2 to reuse. R1 and R2 can be any integer type, and a
+// day without a second answer just leaves out part2. Every step wraps its
+// work in bench phases, so the whole thing can be benchmarked in-process.
+//
+// A day whose answers are single pass folds can also define
+//
+//         static std::pair<R1, R2> stream(aoc::Generator<std::string_view> lines);
+//
+// which gets the input a line at a time as it is read and has to solve it in
+// constant memory. Run with - as the file name, a day's executable streams
+// stdin through it, and a day without one reads all of stdin and solves it
+// as usual.
+//
+// A day with a binary input format (see aoc/binary.h) also defines
+//
+//         static constexpr uint32_t binary_version = 1;
+//         static void compile(const Input& input, aoc::binary::Writer& out);
+//         static Input load(const aoc::binary::Reader& in);
+//
+// compile writes the parsed input out as flat arrays and load builds an
+// Input that views them in place. Anywhere a day is given its input, a
+// binary one is recognised by its header and loaded instead of parsed.
+//
+// A day whose input only ever grows by appending lines can keep its running
+// state between runs with
+//
+//         static constexpr uint32_t checkpoint_version = 1;
+//         struct Checkpoint {
+//             void fold(std::string_view line);
+//             std::pair<R1, R2> answers() const;
+//         };
+//
+// and, unless Checkpoint is trivially copyable, save and restore functions
+// like compile and load above. Run as dayN -c <checkpoint> <input>, a day
+// folds in only the lines after the ones its checkpoint already holds, then
+// rewrites the checkpoint. The checkpoint is the state, written in the
+// binary input format, plus how far into the input it got and a hash of the
+// bytes just before that point. When the input no longer starts with those
+// bytes, it was rewritten rather than appended to, and the day starts over.
+//
+// AOC_DAY(N, label1, label2) after the Solver defines dayN::day, a Day that
+// runs it with the typed results turned into Answers. aoc/registry.h lists
+// every Day for the driver, and tools/day.cc is the thin main each day's
+// standalone executable is built from. Both go through solve_cached, which
+// skips solving entirely when the answers for the input are in the cache.
+//
+// In the embed build (-DAOC_EMBED) each day's data files are compiled into its
+// executable as constexpr string_views, see tools/embed.cc, and the days whose
+// solvers can run in constant expressions static_assert their example answers.
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <optional>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "aoc/bench.h"
+#include "aoc/binary.h"
+#include "aoc/cache.h"
+#include "aoc/generator.h"
+#include "aoc/input.h"
+#include "aoc/output.h"
+#include "aoc/stream.h"
+#include "aoc/trace.h"
+
+namespace aoc {
+
+// An answer is empty when the day has no such part
+using Answer = std::variant<std::monostate, int64_t, uint64_t>;
+
+struct Answers {
+    Answer part1;
+    Answer part2;
+};
+
+struct Day {
+    int number;
+    const char* name;
+    const char* part1_label;
+    const char* part2_label;
+    Answers (*solve)(std::string_view text, bench::Harness& bench);
+    Answers (*stream)(Generator<std::string_view> lines);
+    // Text input to binary input, null for days without a binary format
+    std::string (*compile)(std::string_view text);
+    // Folds the lines of text after those in checkpoint into it, null for
+    // days without an incremental mode
+    Answers (*update)(std::string_view text, std::string& checkpoint);
+};
+
+template <std::integral T>
+Answer to_answer(T value) {
+    if constexpr (std::is_signed_v<T>) {
+        return static_cast<int64_t>(value);
+    }
+    else {
+        return static_cast<uint64_t>(value);
+    }
+}
+
+template <typename Solver>
+concept HasBinaryFormat = requires (const typename Solver::Input& input, binary::Writer& out, const binary::Reader& in) {
+    { Solver::binary_version } -> std::convertible_to<uint32_t>;
+    Solver::compile(input, out);
+    { Solver::load(in) } -> std::same_as<typename Solver::Input>;
+};
+
+// Loads a binary input, or parses a text one
+template <typename Solver, int Number>
+typename Solver::Input load_or_parse(std::string_view text, bench::Harness& bench) {
+    if (binary::is_binary(text)) {
+        if constexpr (HasBinaryFormat<Solver>) {
+            return bench.phase("load_binary", [&] {
+                return Solver::load(binary::Reader(text, Number, Solver::binary_version));
+            });
+        }
+        else {
+            throw std::runtime_error("binary input: day " + std::to_string(Number) + " has no binary format");
+        }
+    }
+    return Solver::parse(text, bench);
+}
+
+template <typename Solver, int Number>
+std::string compile(std::string_view text) {
+    bench::Harness bench("day" + std::to_string(Number), "compile");
+    typename Solver::Input input = load_or_parse<Solver, Number>(text, bench);
+    binary::Writer out;
+    Solver::compile(input, out);
+    return out.finish(Number, Solver::binary_version);
+}
+
+template <typename Solver, int Number>
+Answers solve(std::string_view text, bench::Harness& bench) {
+    typename Solver::Input input = load_or_parse<Solver, Number>(text, bench);
+    Answers answers;
+    answers.part1 = to_answer(Solver::part1(input, bench));
+    if constexpr (requires { Solver::part2(input, bench); }) {
+        answers.part2 = to_answer(Solver::part2(input, bench));
+    }
+    return answers;
+}
+
+template <typename Solver>
+Answers stream(Generator<std::string_view> lines) {
+    auto [part1, part2] = Solver::stream(std::move(lines));
+    return {to_answer(part1), to_answer(part2)};
+}
+
+template <typename Solver>
+concept HasCheckpoint = requires (typename Solver::Checkpoint& state, std::string_view line) {
+    { Solver::checkpoint_version } -> std::convertible_to<uint32_t>;
+    state.fold(line);
+    std::as_const(state).answers();
+};
+
+// Where a checkpoint got to in its input, stored after the day's sections
+struct Progress {
+    uint64_t offset;
+    uint64_t tail_hash;
+};
+
+// Bytes before the offset that have to be unchanged for a checkpoint to be
+// resumed
+constexpr size_t CHECKPOINT_TAIL = 4096;
+
+inline uint64_t tail_hash(std::string_view text, size_t offset) {
+    size_t begin = offset - std::min(offset, CHECKPOINT_TAIL);
+    return cache::hash_bytes(text.substr(begin, offset - begin));
+}
+
+template <typename Solver, int Number>
+Answers update(std::string_view text, std::string& checkpoint) {
+    using Checkpoint = typename Solver::Checkpoint;
+
+    // Resume when the checkpoint is for this day and version and its input
+    // is still there, otherwise start from the beginning
+    Checkpoint state{};
+    size_t offset = 0;
+    try {
+        if (!checkpoint.empty()) {
+            binary::Reader in(checkpoint, Number, Solver::checkpoint_version);
+            std::span<const Progress> progress = in.section<Progress>(in.section_count() - 1);
+            if (progress.size() == 1 && progress[0].offset <= text.size() &&
+                tail_hash(text, progress[0].offset) == progress[0].tail_hash) {
+                if constexpr (std::is_trivially_copyable_v<Checkpoint>) {
+                    std::span<const Checkpoint> saved = in.section<Checkpoint>(0);
+                    if (saved.size() != 1) throw std::runtime_error("checkpoint: no state");
+                    state = saved[0];
+                }
+                else {
+                    state = Solver::restore(in);
+                }
+                offset = progress[0].offset;
+            }
+        }
+    }
+    catch (const std::exception&) {
+        state = Checkpoint{};
+        offset = 0;
+    }
+
+    // Fold in the new complete lines. A last line without its newline may
+    // still be being written, so it counts towards these answers but is left
+    // out of the checkpoint.
+    size_t complete = text.rfind('\n');
+    complete = complete == std::string_view::npos || complete < offset ? offset : complete + 1;
+    for (std::string_view line : lines(text.substr(offset, complete - offset))) {
+        state.fold(line);
+    }
+    Checkpoint last = state;
+    if (complete < text.size()) last.fold(text.substr(complete));
+    auto [part1, part2] = last.answers();
+
+    binary::Writer out;
+    if constexpr (std::is_trivially_copyable_v<Checkpoint>) {
+        out.add(std::span<const Checkpoint>(&state, 1));
+    }
+    else {
+        Solver::save(state, out);
+    }
+    Progress progress = {.offset = complete, .tail_hash = tail_hash(text, complete)};
+    out.add(std::span<const Progress>(&progress, 1));
+    checkpoint = out.finish(Number, Solver::checkpoint_version);
+    return {to_answer(part1), to_answer(part2)};
+}
+
+template <typename Solver, int Number>
+constexpr Day make_day(const char* name, const char* part1_label, const char* part2_label) {
+    Day day = {
+        .number = Number,
+        .name = name,
+        .part1_label = part1_label,
+        .part2_label = part2_label,
+        .solve = solve<Solver, Number>,
+        .stream = nullptr,
+        .compile = nullptr,
+        .update = nullptr,
+    };
+    if constexpr (requires (Generator<std::string_view> lines) { Solver::stream(std::move(lines)); }) {
+        day.stream = stream<Solver>;
+    }
+    if constexpr (HasBinaryFormat<Solver>) {
+        day.compile = compile<Solver, Number>;
+    }
+    if constexpr (HasCheckpoint<Solver>) {
+        day.update = update<Solver, Number>;
+    }
+    return day;
+}
+
+// Each answer on its own line after the day's label for it
+inline std::string format_answers(const Day& day, const Answers& answers) {
+    std::string text;
+    auto write = [&text](const char* label, const Answer& answer) {
+        if (std::holds_alternative<std::monostate>(answer)) return;
+        text += label;
+        std::visit([&text](auto value) {
+            if constexpr (!std::is_same_v<decltype(value), std::monostate>) append_int(text, value);
+        }, answer);
+        text += "\n";
+    };
+    write(day.part1_label, answers.part1);
+    write(day.part2_label, answers.part2);
+    return text;
+}
+
+inline void write_answers(const Day& day, const Answers& answers, std::ostream& out) {
+    out << format_answers(day, answers) << std::flush;
+}
+
+// Answers are stored as a type tag and 8 bytes of value per part
+inline std::string encode_answers(const Answers& answers) {
+    std::string payload;
+    for (const Answer* answer : {&answers.part1, &answers.part2}) {
+        uint64_t bits = 0;
+        if (const int64_t* value = std::get_if<int64_t>(answer)) {
+            payload += 'i';
+            std::memcpy(&bits, value, sizeof(bits));
+        }
+        else if (const uint64_t* value = std::get_if<uint64_t>(answer)) {
+            payload += 'u';
+            bits = *value;
+        }
+        else {
+            payload += '-';
+        }
+        payload.append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+    }
+    return payload;
+}
+
+inline std::optional<Answers> decode_answers(std::string_view payload) {
+    const size_t part_size = 1 + sizeof(uint64_t);
+    if (payload.size() != 2 * part_size) return std::nullopt;
+    Answers answers;
+    for (Answer* answer : {&answers.part1, &answers.part2}) {
+        uint64_t bits;
+        std::memcpy(&bits, payload.data() + 1, sizeof(bits));
+        if (payload[0] == 'i') *answer = static_cast<int64_t>(bits);
+        else if (payload[0] == 'u') *answer = bits;
+        else if (payload[0] != '-') return std::nullopt;
+        payload.remove_prefix(part_size);
+    }
+    return answers;
+}
+
+// Solves the day unless the cache already holds its answers for this input
+// and executable. While it solves, the day's cache::artifact calls can reuse
+// intermediate results from earlier runs.
+inline Answers solve_cached(const Day& day, std::string_view text, bench::Harness& bench, const cache::Cache& store) {
+    if (!store.enabled()) {
+        return day.solve(text, bench);
+    }
+    cache::Context context = {
+        .cache = &store,
+        .day = day.name,
+        .input_hash = cache::hash_bytes(text),
+    };
+    std::string key = context.day + "-" + cache::to_hex(context.input_hash) + "-" + cache::to_hex(cache::build_id()) + ".ans";
+    if (std::optional<std::string> payload = store.load(key)) {
+        if (std::optional<Answers> answers = decode_answers(*payload)) {
+            return *answers;
+        }
+    }
+    cache::Scope scope(context);
+    Answers answers = day.solve(text, bench);
+    store.store(key, encode_answers(answers));
+    return answers;
+}
+
+// Solves text and prints the answers, then the bench and trace reports
+inline void solve_and_print(const Day& day, const std::string& input_name, std::string_view text) {
+    bench::Harness bench(day.name, input_name);
+    Answers answers = solve_cached(day, text, bench, cache::Cache());
+    print(format_answers(day, answers));
+    bench.report();
+    trace::report();
+}
+
+// Folds what was appended to the input since the checkpoint was written into
+// it, prints the answers and rewrites the checkpoint
+inline int update_main(const Day& day, const std::string& checkpoint_path, const std::string& input_path) {
+    if (day.update == nullptr) {
+        print(std::string("Error: ") + day.name + " has no incremental mode\n");
+        return EXIT_FAILURE;
+    }
+    try {
+        std::string checkpoint;
+        if (::access(checkpoint_path.c_str(), F_OK) == 0) {
+            MappedFile saved(checkpoint_path);
+            checkpoint = saved.view();
+        }
+        MappedFile input(input_path);
+        print(format_answers(day, day.update(input.view(), checkpoint)));
+
+        // Through a temporary file, so a failed run leaves the old one
+        std::string tmp = checkpoint_path + ".tmp";
+        int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool written = fd >= 0 && write_all(fd, checkpoint);
+        if (fd >= 0 && ::close(fd) != 0) written = false;
+        if (!written || ::rename(tmp.c_str(), checkpoint_path.c_str()) != 0) {
+            throw std::system_error(errno, std::generic_category(), "write " + checkpoint_path);
+        }
+    }
+    catch (const std::exception& err) {
+        print(std::string("Error: ") + err.what() + "\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+inline int day_main(const Day& day, int argc, char **argv) {
+
+    // Check inputs
+    if (argc == 4 && std::string_view(argv[1]) == "-c") {
+        return update_main(day, argv[2], argv[3]);
+    }
+    if (argc != 2) {
+        print("Input filename must be provided\n");
+        return EXIT_FAILURE;
+    }
+
+    // Stream stdin through the day if it can, or read all of it
+    if (std::string_view(argv[1]) == "-") {
+        if (day.stream != nullptr) {
+            print(format_answers(day, day.stream(stream_lines(STDIN_FILENO))));
+            return EXIT_SUCCESS;
+        }
+        // Byte for byte, as it may be a binary input
+        std::string text;
+        char buffer[64 << 10];
+        ssize_t got;
+        while ((got = ::read(STDIN_FILENO, buffer, sizeof(buffer))) != 0) {
+            if (got < 0 && errno == EINTR) continue;
+            if (got < 0) {
+                print(std::string("Error: reading stdin: ") + std::strerror(errno) + "\n");
+                return EXIT_FAILURE;
+            }
+            text.append(buffer, static_cast<size_t>(got));
+        }
+        solve_and_print(day, "stdin", text);
+        return EXIT_SUCCESS;
+    }
+
+    // Map the input file and solve it. Unreadable files and binary inputs
+    // for another day or format version end up here.
+    try {
+        MappedFile input(argv[1]);
+        solve_and_print(day, argv[1], input.view());
+    }
+    catch (const std::exception& err) {
+        print(std::string("Error: ") + err.what() + "\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// For executables with the day's data compiled in (make embed). With no
+// arguments the embedded input is solved, -e solves the embedded example and
+// a file name is read as usual.
+inline int embedded_main(const Day& day, std::string_view input, std::string_view example, int argc, char **argv) {
+    if (argc == 1 || (argc == 2 && std::string_view(argv[1]) == "-e")) {
+        bool use_example = argc == 2;
+        std::string_view text = use_example ? example : input;
+        if (text.empty()) {
+            print(std::string("No ") + (use_example ? "example" : "input") + " was embedded in " + day.name + "\n");
+            return EXIT_FAILURE;
+        }
+        solve_and_print(day, use_example ? "embedded example.dat" : "embedded input.dat", text);
+        return EXIT_SUCCESS;
+    }
+    return day_main(day, argc, argv);
+}
+
+} // namespace aoc
+
+// Defined inside namespace dayN after its Solver
+#define AOC_DAY(number, part1_label, part2_label) \
+    extern const aoc::Day day = aoc::make_day<Solver, number>("day" #number, part1_label, part2_label)
@@ -0,0 +1,109 @@
+// Lazy coroutine generator, a stand-in for C++23 std::generator
+//
+// GCC 12's library has no <generator>, so this covers the part of it the
+// streaming solvers use: a coroutine that co_yields values of T is a range
+// that can be walked once with range-for, resuming the coroutine for each
+// element. A yielded value is only valid until the iterator is advanced, so a
+// stage can yield the same buffer over and over without copying it.
+//
+//     aoc::Generator<int> count(int n) {
+//         for (int ii=0; ii<n; ii++) co_yield ii;
+//     }
+//
+// Exceptions thrown in the coroutine come out of begin() or operator++.
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace aoc {
+
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        const T* value = nullptr;
+        std::exception_ptr error;
+
+        Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+
+        // A temporary lives until the coroutine resumes, so both work
+        std::suspend_always yield_value(const T& yielded) noexcept {
+            value = std::addressof(yielded);
+            return {};
+        }
+
+        // Generators are only ever walked, never awaited
+        void await_transform() = delete;
+    };
+
+    using handle_type = std::coroutine_handle<promise_type>;
+
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        iterator() = default;
+        explicit iterator(handle_type handle) : handle_(handle) {}
+
+        reference operator*() const { return *handle_.promise().value; }
+        pointer operator->() const { return handle_.promise().value; }
+        iterator& operator++() {
+            resume(handle_);
+            return *this;
+        }
+        void operator++(int) { ++(*this); }
+        bool operator==(std::default_sentinel_t) const { return !handle_ || handle_.done(); }
+
+    private:
+        handle_type handle_;
+    };
+
+    Generator() = default;
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+    Generator(Generator&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    ~Generator() {
+        if (handle_) handle_.destroy();
+    }
+
+    // Starts the coroutine, so call it once
+    iterator begin() {
+        if (handle_) resume(handle_);
+        return iterator(handle_);
+    }
+    std::default_sentinel_t end() const { return std::default_sentinel; }
+
+private:
+    explicit Generator(handle_type handle) : handle_(handle) {}
+
+    static void resume(handle_type handle) {
+        handle.resume();
+        if (handle.promise().error) {
+            std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+        }
+    }
+
+    handle_type handle_;
+};
+
+} // namespace aoc
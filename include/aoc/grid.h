@@ -0,0 +1,92 @@
+// Flat two dimensional grid with a sentinel border
+//
+// The cells are one contiguous array, row after row, and every row is framed
+// by border cells of a fill value on each side, with as many rows of them
+// above and below. Neighbours are plain offsets from a cell (one to either
+// side, stride() up or down), and with a border of one every cell of the
+// grid has all eight of its neighbours in the array. Loops over the grid
+// need no bounds checks, and a row is a flat run of width() cells with its
+// neighbours stride() cells away, which is what the SIMD kernels want.
+//
+// Coordinates are signed and go from -border to width + border - 1 (or
+// height + border - 1), so the border can be read and written like any
+// other cell. Everything works in constant expressions.
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "aoc/input.h"
+
+namespace aoc {
+
+template <typename T>
+class Grid {
+public:
+    constexpr Grid() = default;
+
+    constexpr Grid(size_t width, size_t height, size_t border, T fill)
+        : width_(width), height_(height), border_(border), stride_(width + 2 * border),
+          cells_((height + 2 * border) * stride_, fill) {}
+
+    constexpr size_t width() const { return width_; }
+    constexpr size_t height() const { return height_; }
+    constexpr size_t border() const { return border_; }
+
+    // Distance between vertically neighbouring cells
+    constexpr ptrdiff_t stride() const { return static_cast<ptrdiff_t>(stride_); }
+
+    constexpr T& operator()(ptrdiff_t x, ptrdiff_t y) { return cells_[index(x, y)]; }
+    constexpr const T& operator()(ptrdiff_t x, ptrdiff_t y) const { return cells_[index(x, y)]; }
+
+    // The first cell of row y, the others follow it and the border is at
+    // negative offsets and from width() on
+    constexpr T* row(ptrdiff_t y) { return cells_.data() + index(0, y); }
+    constexpr const T* row(ptrdiff_t y) const { return cells_.data() + index(0, y); }
+
+    constexpr bool operator==(const Grid&) const = default;
+
+private:
+    constexpr size_t index(ptrdiff_t x, ptrdiff_t y) const {
+        return static_cast<size_t>((y + static_cast<ptrdiff_t>(border_)) * static_cast<ptrdiff_t>(stride_) +
+                                   x + static_cast<ptrdiff_t>(border_));
+    }
+
+    size_t width_ = 0;
+    size_t height_ = 0;
+    size_t border_ = 0;
+    size_t stride_ = 0;
+    std::vector<T> cells_;
+};
+
+// The lines of text up to the first empty one as a grid, each character
+// turned into a cell by convert. Short lines are padded with fill, as is the
+// border.
+template <typename T, typename Convert>
+constexpr Grid<T> read_grid(std::string_view text, size_t border, T fill, Convert convert) {
+    size_t width = 0;
+    size_t height = 0;
+    for (std::string_view line : lines(text)) {
+        if (line.empty()) break;
+        width = std::max(width, line.size());
+        height++;
+    }
+    Grid<T> grid(width, height, border, fill);
+    ptrdiff_t yy = 0;
+    for (std::string_view line : lines(text)) {
+        if (line.empty()) break;
+        T* row = grid.row(yy++);
+        for (size_t xx=0; xx<line.size(); xx++) {
+            row[xx] = convert(line[xx]);
+        }
+    }
+    return grid;
+}
+
+constexpr Grid<char> read_grid(std::string_view text, size_t border, char fill) {
+    return read_grid<char>(text, border, fill, [](char c) { return c; });
+}
+
+} // namespace aoc
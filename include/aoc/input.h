@@ -0,0 +1,232 @@
+// Zero-copy input handling shared by all of the days
+//
+// The input file is memory mapped once and everything handed out afterwards
+// is a std::string_view into that mapping, so splitting lines and fields
+// never copies or allocates. Any view obtained from a MappedFile is only valid
+// for as long as the MappedFile itself is alive.
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace aoc {
+
+// Read-only memory map of an entire file
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& fname) {
+        int fd = ::open(fname.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "open " + fname);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::system_error(err, std::generic_category(), "stat " + fname);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        // mmap refuses zero length mappings, an empty file is just an empty view
+        if (size_ > 0) {
+            void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                int err = errno;
+                ::close(fd);
+                throw std::system_error(err, std::generic_category(), "mmap " + fname);
+            }
+            ::madvise(addr, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(addr);
+        }
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : data_(std::exchange(other.data_, nullptr)),
+          size_(std::exchange(other.size_, 0)) {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() { unmap(); }
+
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    std::string_view view() const { return {data_, size_}; }
+
+private:
+    void unmap() {
+        if (data_ != nullptr) {
+            ::munmap(const_cast<char*>(data_), size_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+// Splits text on a single delimiter with the same rules as std::getline: every
+// delimiter ends a field, and a trailing delimiter does not produce an extra
+// empty field at the end. Works both as a cursor (next) and as a range, and
+// in constant expressions.
+class Splitter {
+public:
+    constexpr explicit Splitter(std::string_view text, char delim = '\n')
+        : rest_(text), delim_(delim), done_(text.empty()) {}
+
+    constexpr bool next(std::string_view& field) {
+        if (done_) return false;
+        size_t idx = rest_.find(delim_);
+        if (idx == std::string_view::npos) {
+            field = rest_;
+            rest_ = {};
+            done_ = true;
+        }
+        else {
+            field = rest_.substr(0, idx);
+            rest_.remove_prefix(idx + 1);
+            done_ = rest_.empty();
+        }
+        return true;
+    }
+
+    // Everything that has not been handed out yet
+    constexpr std::string_view remaining() const { return rest_; }
+
+    class iterator;
+    constexpr iterator begin() const;
+    constexpr iterator end() const;
+
+private:
+    std::string_view rest_;
+    char delim_;
+    bool done_;
+};
+
+class Splitter::iterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view*;
+    using reference = const std::string_view&;
+
+    iterator() = default;
+    constexpr explicit iterator(Splitter splitter) : splitter_(splitter) { ++(*this); }
+
+    constexpr reference operator*() const { return field_; }
+    constexpr pointer operator->() const { return &field_; }
+    constexpr iterator& operator++() {
+        valid_ = splitter_.next(field_);
+        return *this;
+    }
+    constexpr iterator operator++(int) {
+        iterator prev = *this;
+        ++(*this);
+        return prev;
+    }
+    constexpr bool operator==(const iterator& other) const {
+        // Only comparisons against the end iterator are meaningful
+        return valid_ == other.valid_ && (!valid_ || field_.data() == other.field_.data());
+    }
+
+private:
+    Splitter splitter_{std::string_view{}};
+    std::string_view field_;
+    bool valid_ = false;
+};
+
+constexpr Splitter::iterator Splitter::begin() const { return iterator(*this); }
+constexpr Splitter::iterator Splitter::end() const { return iterator(); }
+
+constexpr Splitter lines(std::string_view text) { return Splitter(text, '\n'); }
+constexpr Splitter fields(std::string_view text, char delim) { return Splitter(text, delim); }
+
+// Splits text on runs of whitespace and never yields empty words, the same as
+// reading with operator>> from a stream
+class Words {
+public:
+    constexpr explicit Words(std::string_view text) : rest_(text) {}
+
+    constexpr bool next(std::string_view& word) {
+        size_t start = rest_.find_first_not_of(" \t\r\n\v\f");
+        if (start == std::string_view::npos) {
+            rest_ = {};
+            return false;
+        }
+        rest_.remove_prefix(start);
+        size_t stop = rest_.find_first_of(" \t\r\n\v\f");
+        if (stop == std::string_view::npos) stop = rest_.size();
+        word = rest_.substr(0, stop);
+        rest_.remove_prefix(stop);
+        return true;
+    }
+
+    constexpr std::string_view remaining() const { return rest_; }
+
+    class iterator;
+    constexpr iterator begin() const;
+    constexpr iterator end() const;
+
+private:
+    std::string_view rest_;
+};
+
+class Words::iterator {
+public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view*;
+    using reference = const std::string_view&;
+
+    iterator() = default;
+    constexpr explicit iterator(Words words) : words_(words) { ++(*this); }
+
+    constexpr reference operator*() const { return word_; }
+    constexpr pointer operator->() const { return &word_; }
+    constexpr iterator& operator++() {
+        valid_ = words_.next(word_);
+        return *this;
+    }
+    constexpr iterator operator++(int) {
+        iterator prev = *this;
+        ++(*this);
+        return prev;
+    }
+    constexpr bool operator==(const iterator& other) const {
+        return valid_ == other.valid_ && (!valid_ || word_.data() == other.word_.data());
+    }
+
+private:
+    Words words_{std::string_view{}};
+    std::string_view word_;
+    bool valid_ = false;
+};
+
+constexpr Words::iterator Words::begin() const { return iterator(*this); }
+constexpr Words::iterator Words::end() const { return iterator(); }
+
+constexpr Words words(std::string_view text) { return Words(text); }
+
+} // namespace aoc
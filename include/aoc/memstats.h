@@ -0,0 +1,133 @@
+// Heap allocation counting and peak RSS per bench phase
+//
+// Built with -DAOC_MEMSTATS (make bench-memory) the global operator new and
+// delete are replaced by ones that count every allocation, see
+// aoc/memstats_hooks.h, and every Harness::phase records for its final call:
+//
+//   allocations      operator new calls made during the phase
+//   allocated_bytes  bytes they asked the allocator for, as malloc sees them
+//   peak_live_bytes  most heap in use at any point during the phase, which
+//                    includes whatever earlier phases left allocated
+//   peak_rss_kb      peak resident set size during the phase
+//
+// The peak RSS is reset before each phase through /proc/self/clear_refs. When
+// that is not possible it falls back to the process-wide high water mark.
+//
+// The counters are global, so the numbers are only meaningful while a single
+// day runs at a time, i.e. in the per-day executables or aoc -j 1.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+namespace aoc::memstats {
+
+#ifdef AOC_MEMSTATS
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+struct Counters {
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> allocated_bytes{0};
+    std::atomic<uint64_t> live_bytes{0};
+    std::atomic<uint64_t> peak_live_bytes{0};
+};
+
+// Constant initialized, so it is usable from operator new before main
+inline Counters counters;
+
+// Sizes come from malloc_usable_size, so frees need no size of their own
+inline void on_alloc(void* ptr) {
+    if (ptr == nullptr) return;
+    uint64_t size = malloc_usable_size(ptr);
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    uint64_t live = counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    uint64_t peak = counters.peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !counters.peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+inline void on_free(void* ptr) {
+    if (ptr == nullptr) return;
+    counters.live_bytes.fetch_sub(malloc_usable_size(ptr), std::memory_order_relaxed);
+}
+
+// Starts a new peak RSS measurement, false when the kernel does not allow it
+inline bool reset_peak_rss() {
+    std::FILE* file = std::fopen("/proc/self/clear_refs", "w");
+    if (file == nullptr) return false;
+    bool ok = std::fputs("5", file) >= 0;
+    return std::fclose(file) == 0 && ok;
+}
+
+// VmHWM from /proc/self/status, or ru_maxrss when that cannot be read
+inline int64_t peak_rss_kb() {
+    if (std::FILE* file = std::fopen("/proc/self/status", "r")) {
+        char line[256];
+        long long value = -1;
+        while (std::fgets(line, sizeof(line), file)) {
+            if (std::strncmp(line, "VmHWM:", 6) == 0) {
+                value = std::strtoll(line + 6, nullptr, 10);
+                break;
+            }
+        }
+        std::fclose(file);
+        if (value >= 0) return value;
+    }
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+struct PhaseMemory {
+    std::string name;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    uint64_t peak_live_bytes;
+    int64_t peak_rss_kb;
+};
+
+// Measures from construction to destruction and appends the result to out
+class Probe {
+public:
+    Probe(const char* name, std::vector<PhaseMemory>& out) : name_(name), out_(out) {
+        reset_peak_rss();
+        counters.peak_live_bytes.store(counters.live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        allocations_ = counters.allocations.load(std::memory_order_relaxed);
+        allocated_bytes_ = counters.allocated_bytes.load(std::memory_order_relaxed);
+    }
+
+    ~Probe() {
+        // Read everything before push_back allocates
+        PhaseMemory stats = {
+            .name = {},
+            .allocations = counters.allocations.load(std::memory_order_relaxed) - allocations_,
+            .allocated_bytes = counters.allocated_bytes.load(std::memory_order_relaxed) - allocated_bytes_,
+            .peak_live_bytes = counters.peak_live_bytes.load(std::memory_order_relaxed),
+            .peak_rss_kb = peak_rss_kb(),
+        };
+        stats.name = name_;
+        out_.push_back(std::move(stats));
+    }
+
+    Probe(const Probe&) = delete;
+    Probe& operator=(const Probe&) = delete;
+
+private:
+    const char* name_;
+    std::vector<PhaseMemory>& out_;
+    uint64_t allocations_;
+    uint64_t allocated_bytes_;
+};
+
+} // namespace aoc::memstats
@@ -0,0 +1,56 @@
+// Replacement global operator new and delete for aoc/memstats.h
+//
+// Include from exactly one translation unit of each program, the one with
+// main. Without -DAOC_MEMSTATS this is empty and the standard ones are used.
+//
+// libstdc++ implements the array and nothrow forms on top of these. The sized
+// deletes are defined too, since GCC asks for them alongside the unsized ones.
+#pragma once
+
+#ifdef AOC_MEMSTATS
+
+#include <cstdlib>
+#include <new>
+
+#include "aoc/memstats.h"
+
+// Inlined into callers these look like free on memory from new, which they are
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(std::size_t size) {
+    void* ptr = std::malloc(size ? size : 1);
+    if (ptr == nullptr) throw std::bad_alloc();
+    aoc::memstats::on_alloc(ptr);
+    return ptr;
+}
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    std::size_t alignment = static_cast<std::size_t>(align);
+    void* ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    if (ptr == nullptr) throw std::bad_alloc();
+    aoc::memstats::on_alloc(ptr);
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    aoc::memstats::on_free(ptr);
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    aoc::memstats::on_free(ptr);
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    ::operator delete(ptr);
+}
+
+void operator delete(void* ptr, std::size_t, std::align_val_t align) noexcept {
+    ::operator delete(ptr, align);
+}
+
+#pragma GCC diagnostic pop
+
+#endif
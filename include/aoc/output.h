@@ -0,0 +1,44 @@
+// Console output without iostreams
+//
+// Including <iostream> puts a static initializer in every translation unit
+// that constructs the standard streams and their locales before main runs,
+// which is a fair share of a day that solves in a millisecond. So nothing a
+// day's executable is built from includes it: answers, errors and reports are
+// formatted into a std::string, numbers with std::to_chars, which ignores the
+// locale, and the whole thing goes out with a single write(2). The tools that
+// run many days in one process are free to use iostreams.
+#pragma once
+
+#include <cerrno>
+#include <charconv>
+#include <string>
+#include <string_view>
+
+#include <unistd.h>
+
+namespace aoc {
+
+// Writes all of text to fd, returns false if the write fails
+inline bool write_all(int fd, std::string_view text) {
+    while (!text.empty()) {
+        ssize_t wrote = ::write(fd, text.data(), text.size());
+        if (wrote < 0 && errno == EINTR) continue;
+        if (wrote <= 0) return false;
+        text.remove_prefix(static_cast<size_t>(wrote));
+    }
+    return true;
+}
+
+// Prints text on stdout
+inline void print(std::string_view text) {
+    write_all(STDOUT_FILENO, text);
+}
+
+// Appends an integer in decimal
+template <typename T>
+void append_int(std::string& out, T value) {
+    char digits[24];
+    out.append(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr);
+}
+
+} // namespace aoc
@@ -0,0 +1,410 @@
+// Work-stealing thread pool with parallel_for and parallel_reduce
+//
+// The solvers share one pool, parallel::pool(), sized by AOC_THREADS (default
+// one thread per core, 1 runs everything on the calling thread) or by the -j
+// of the aoc driver and the aocd daemon (init_pool), which run their days on
+// it too.
+// Every worker owns a queue: it takes its own work from the back and, when
+// that runs dry, steals from the front of the others'. The thread that starts
+// a loop works through the queues too until its loop is done, so a loop
+// started from inside another one, or from a day the driver is running on the
+// pool, never deadlocks.
+//
+// Loops are split into chunks of grain items. The chunk boundaries depend only
+// on the item count and the grain, never on the number of threads, and
+// parallel_reduce combines the per-chunk results in chunk order, so its result
+// is the same for every thread count even for operations that are not
+// associative.
+//
+// parallel_parse does the same for reading inputs: the text is cut into
+// pieces of about a grain of bytes at record boundaries, each piece is parsed
+// into its own vector on the pool and the vectors are joined in order.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aoc::parallel {
+
+// AOC_THREADS, or one per hardware thread when it is unset or 0
+inline size_t default_threads() {
+    size_t threads = 0;
+    if (const char* value = std::getenv("AOC_THREADS")) {
+        threads = std::strtoull(value, nullptr, 10);
+    }
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    return threads;
+}
+
+class Pool {
+public:
+    // threads counts the calling thread, so threads - 1 workers are started
+    explicit Pool(size_t threads) : queues_(std::max<size_t>(1, threads)) {
+        for (size_t ii=1; ii<queues_.size(); ii++) {
+            workers_.emplace_back([this, ii] { work(ii); });
+        }
+    }
+
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+
+    ~Pool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t size() const { return queues_.size(); }
+
+    // Calls task(ii) for every ii in [0, count) and returns once all are done.
+    // The first exception thrown by a task is rethrown here.
+    void run(size_t count, const std::function<void(size_t)>& task) {
+        if (count == 0) return;
+        if (workers_.empty() || count == 1) {
+            for (size_t ii=0; ii<count; ii++) task(ii);
+            return;
+        }
+        Job job(task, count);
+
+        // Deal the items out so every worker starts on its own share
+        for (size_t ii=0; ii<count; ii++) {
+            Queue& queue = queues_[ii % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.items.push_back({&job, ii});
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            queued_ += count;
+        }
+        wake_.notify_all();
+
+        // Help with this job's items until none are left to take, then wait
+        // for the ones still running elsewhere. Done is only ever read under
+        // the job's mutex, so the job outlives the last thread that touches it.
+        while (take_and_run(own_queue(), &job)) {}
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.finished.wait(lock, [&job] { return job.done; });
+        if (job.error) std::rethrow_exception(job.error);
+    }
+
+    // Queues fn for the workers and returns a future for its result, without
+    // the calling thread helping, and exceptions thrown by fn are rethrown
+    // from future::get. Without workers fn runs before this returns.
+    template <typename F>
+    std::future<std::invoke_result_t<F>> submit(F&& fn) {
+        using Result = std::invoke_result_t<F>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(fn));
+        std::future<Result> result = task->get_future();
+        if (workers_.empty()) {
+            (*task)();
+            return result;
+        }
+        // Deleted by the worker that runs it
+        Detached* detached = new Detached([task](size_t) { (*task)(); });
+        {
+            Queue& queue = queues_[1 + next_worker_++ % workers_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.items.push_back({&detached->job, 0});
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            queued_++;
+        }
+        wake_.notify_one();
+        return result;
+    }
+
+private:
+    struct Detached;
+
+    struct Job {
+        Job(const std::function<void(size_t)>& task, size_t count, Detached* owner = nullptr)
+            : task(task), remaining(count), owner(owner) {}
+
+        const std::function<void(size_t)>& task;
+        size_t remaining;
+        bool done = false;
+        std::exception_ptr error;
+        std::mutex mutex;
+        std::condition_variable finished;
+        // Set for a submitted task, which nobody waits for here
+        Detached* owner;
+    };
+
+    struct Detached {
+        explicit Detached(std::function<void(size_t)> fn) : task(std::move(fn)), job(task, 1, this) {}
+
+        std::function<void(size_t)> task;
+        Job job;
+    };
+
+    struct Item {
+        Job* job;
+        size_t index;
+    };
+
+    // Padded so neighbouring queues' locks don't share a cache line
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Item> items;
+    };
+
+    // The worker running on this thread, if any, so a loop started from a
+    // worker helps from that worker's own queue. Threads outside the pool
+    // share queue 0.
+    struct Worker {
+        const Pool* pool;
+        size_t queue;
+    };
+    static inline thread_local Worker worker_{nullptr, 0};
+
+    size_t own_queue() const {
+        return worker_.pool == this ? worker_.queue : 0;
+    }
+
+    // Takes an item, from the back of queue own or else the front of any
+    // other, and runs it. With only set just the items of that job are taken,
+    // so a thread waiting for its own loop never runs unrelated work, such
+    // as a whole request submitted to the daemon, on its stack. Returns false
+    // when there is nothing it may take.
+    bool take_and_run(size_t own, const Job* only = nullptr) {
+        auto allowed = [only](const Item& item) { return only == nullptr || item.job == only; };
+        Item item;
+        bool found = false;
+        for (size_t ii=0; ii<queues_.size() && !found; ii++) {
+            Queue& queue = queues_[(own + ii) % queues_.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (ii == 0) {
+                auto last = std::find_if(queue.items.rbegin(), queue.items.rend(), allowed);
+                if (last == queue.items.rend()) continue;
+                item = *last;
+                queue.items.erase(std::next(last).base());
+            }
+            else {
+                auto first = std::find_if(queue.items.begin(), queue.items.end(), allowed);
+                if (first == queue.items.end()) continue;
+                item = *first;
+                queue.items.erase(first);
+            }
+            found = true;
+        }
+        if (!found) return false;
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            queued_--;
+        }
+
+        std::exception_ptr error;
+        try {
+            item.job->task(item.index);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        Job& job = *item.job;
+        if (job.owner) {
+            delete job.owner;
+            return true;
+        }
+        std::lock_guard<std::mutex> lock(job.mutex);
+        if (error && !job.error) job.error = error;
+        if (--job.remaining == 0) {
+            job.done = true;
+            job.finished.notify_all();
+        }
+        return true;
+    }
+
+    void work(size_t own) {
+        worker_ = {this, own};
+        while (true) {
+            if (take_and_run(own)) continue;
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            wake_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+            if (stopping_ && queued_ == 0) return;
+        }
+    }
+
+    std::vector<Queue> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    size_t queued_ = 0;
+    bool stopping_ = false;
+    std::atomic<size_t> next_worker_{0};
+};
+
+// The size init_pool asked for, and whether pool() has started the pool
+struct PoolSetup {
+    std::mutex mutex;
+    size_t threads = 0;
+    bool started = false;
+};
+
+inline PoolSetup& pool_setup() {
+    static PoolSetup setup;
+    return setup;
+}
+
+// Sets the size of the shared pool, 0 for default_threads(). Only possible
+// before its first use, throws std::logic_error once it has started.
+inline void init_pool(size_t threads) {
+    PoolSetup& setup = pool_setup();
+    std::lock_guard<std::mutex> lock(setup.mutex);
+    if (setup.started) throw std::logic_error("parallel::init_pool after the shared pool started");
+    setup.threads = threads;
+}
+
+// The pool every solver shares, started on first use
+inline Pool& pool() {
+    static Pool shared([] {
+        PoolSetup& setup = pool_setup();
+        std::lock_guard<std::mutex> lock(setup.mutex);
+        setup.started = true;
+        return setup.threads ? setup.threads : default_threads();
+    }());
+    return shared;
+}
+
+// Number of chunks of grain items that count items are split into
+inline size_t chunk_count(size_t count, size_t grain) {
+    grain = std::max<size_t>(1, grain);
+    return (count + grain - 1) / grain;
+}
+
+// Calls body(begin, end) for consecutive chunks of at most grain items that
+// together cover [0, count)
+template <typename Body>
+void parallel_for(size_t count, size_t grain, Body&& body) {
+    grain = std::max<size_t>(1, grain);
+    pool().run(chunk_count(count, grain), [&](size_t chunk) {
+        body(chunk * grain, std::min(count, (chunk + 1) * grain));
+    });
+}
+
+// Folds map(begin, end) over the chunks of [0, count) into init with
+// combine, in chunk order
+template <typename T, typename Map, typename Combine>
+T parallel_reduce(size_t count, size_t grain, T init, Map&& map, Combine&& combine) {
+    grain = std::max<size_t>(1, grain);
+    std::vector<T> partials(chunk_count(count, grain), init);
+    pool().run(partials.size(), [&](size_t chunk) {
+        partials[chunk] = map(chunk * grain, std::min(count, (chunk + 1) * grain));
+    });
+    T result = init;
+    for (const T& partial : partials) {
+        result = combine(result, partial);
+    }
+    return result;
+}
+
+// parallel_reduce for the common case of summing a value per item
+template <typename T, typename F>
+T parallel_sum(size_t count, size_t grain, F&& value) {
+    return parallel_reduce<T>(count, grain, T{}, [&](size_t begin, size_t end) {
+        T sum{};
+        for (size_t ii=begin; ii<end; ii++) {
+            sum += value(ii);
+        }
+        return sum;
+    }, [](T a, T b) { return a + b; });
+}
+
+// Inputs are parsed in pieces of this many bytes, enough that a piece takes
+// far longer to parse than to hand to a worker. The puzzle inputs fit in one.
+constexpr size_t PARSE_GRAIN = 1 << 18;
+
+// Cuts text into pieces of at least grain bytes that each end just after a
+// delim, the last one at the end of text, so no record is split between two
+// pieces. Like the loop chunks, the cuts depend only on the text and grain.
+inline std::vector<std::string_view> split_records(std::string_view text, char delim, size_t grain) {
+    grain = std::max<size_t>(1, grain);
+    std::vector<std::string_view> pieces;
+    while (!text.empty()) {
+        size_t cut = text.size();
+        if (text.size() > grain) {
+            size_t found = text.find(delim, grain - 1);
+            if (found != std::string_view::npos) cut = found + 1;
+        }
+        pieces.push_back(text.substr(0, cut));
+        text.remove_prefix(cut);
+    }
+    return pieces;
+}
+
+// Parses the delim separated records of text on the given pool. parse(piece,
+// records) appends the records of one piece to records and returns false when
+// it reaches the end of the input inside the piece, e.g. at a blank line; the
+// pieces after that one are dropped, along with anything they threw. The
+// result is the same as parsing the whole text in one piece.
+template <typename T, typename Parse>
+std::vector<T> parallel_parse(Pool& on, std::string_view text, char delim, size_t grain, Parse&& parse) {
+    std::vector<std::string_view> pieces = split_records(text, delim, grain);
+    if (pieces.size() <= 1) {
+        std::vector<T> records;
+        if (!pieces.empty()) parse(pieces[0], records);
+        return records;
+    }
+
+    struct Part {
+        std::vector<T> records;
+        bool more = true;
+        std::exception_ptr error;
+    };
+    std::vector<Part> parts(pieces.size());
+    on.run(pieces.size(), [&](size_t piece) {
+        try {
+            parts[piece].more = parse(pieces[piece], parts[piece].records);
+        }
+        catch (...) {
+            parts[piece].error = std::current_exception();
+        }
+    });
+
+    // Stitch the parts up to the one that ended the input, each copied to its
+    // place by the thread that takes it
+    std::vector<size_t> offsets;
+    size_t total = 0;
+    for (const Part& part : parts) {
+        if (part.error) std::rethrow_exception(part.error);
+        offsets.push_back(total);
+        total += part.records.size();
+        if (!part.more) break;
+    }
+    if (offsets.size() == 1) return std::move(parts[0].records);
+    std::vector<T> records(total);
+    on.run(offsets.size(), [&](size_t piece) {
+        std::copy(parts[piece].records.begin(), parts[piece].records.end(), records.begin() + offsets[piece]);
+    });
+    return records;
+}
+
+// parallel_parse on the shared pool
+template <typename T, typename Parse>
+std::vector<T> parallel_parse(std::string_view text, char delim, Parse&& parse) {
+    return parallel_parse<T>(pool(), text, delim, PARSE_GRAIN, std::forward<Parse>(parse));
+}
+
+} // namespace aoc::parallel
@@ -0,0 +1,197 @@
+// Allocation-free integer parsing shared by all of the days
+//
+// Two interchangeable paths are provided. parse_int_fc is a thin wrapper over
+// std::from_chars and is the reference implementation. parse_int is the one
+// the readers use; it consumes eight ASCII digits at a time with SWAR
+// arithmetic on a single 64-bit word and also handles 128-bit integers, which
+// std::from_chars does not. Both parse the leading number of a field, ignore
+// anything after it, and throw like std::stoull when there is no number.
+// parse_int and the helpers built on it also work in constant expressions,
+// where the SWAR loop is skipped.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace aoc {
+
+__extension__ typedef __int128 int128;
+__extension__ typedef unsigned __int128 uint128;
+
+// std::is_integral and std::make_unsigned don't know about __int128 in strict
+// ISO mode, so the parsers carry their own traits
+template <typename T>
+struct int_traits {
+    static constexpr bool is_signed = std::is_signed_v<T>;
+    using unsigned_type = std::make_unsigned_t<T>;
+};
+template <>
+struct int_traits<int128> {
+    static constexpr bool is_signed = true;
+    using unsigned_type = uint128;
+};
+template <>
+struct int_traits<uint128> {
+    static constexpr bool is_signed = false;
+    using unsigned_type = uint128;
+};
+
+// Number of decimal digits that always fit in an unsigned type
+template <typename U>
+constexpr size_t safe_digits() {
+    switch (sizeof(U)) {
+        case 1: return 2;
+        case 2: return 4;
+        case 4: return 9;
+        case 8: return 19;
+        default: return 38;
+    }
+}
+
+// True when all eight bytes of the little-endian word are ASCII digits
+constexpr bool is_eight_digits(uint64_t chunk) {
+    return ((chunk & 0xF0F0F0F0F0F0F0F0) |
+            (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) == 0x3333333333333333;
+}
+
+// Converts eight ASCII digits loaded as a little-endian word into their value
+// by combining pairs, then quads, then the two halves
+constexpr uint32_t parse_eight_digits(uint64_t chunk) {
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10) + (chunk >> 8);
+    chunk = (((chunk & 0x000000FF000000FF) * (100 + (1000000ULL << 32))) +
+             (((chunk >> 16) & 0x000000FF000000FF) * (1 + (10000ULL << 32)))) >> 32;
+    return static_cast<uint32_t>(chunk);
+}
+
+inline uint64_t load_chunk(const char* ptr) {
+    uint64_t chunk;
+    std::memcpy(&chunk, ptr, sizeof(chunk));
+    return chunk;
+}
+
+[[noreturn]] inline void throw_parse_error(std::string_view text, bool out_of_range) {
+    if (out_of_range) {
+        throw std::out_of_range("parse_int: " + std::string(text));
+    }
+    throw std::invalid_argument("parse_int: " + std::string(text));
+}
+
+// Parses the leading number at the front of text and drops it (and nothing
+// else) from the view, which makes it easy to walk fields in place
+template <typename T>
+constexpr T consume_int(std::string_view& text) {
+    using U = typename int_traits<T>::unsigned_type;
+    const std::string_view original = text;
+    const char* ptr = text.data();
+    const char* end = ptr + text.size();
+
+    bool negative = false;
+    if constexpr (int_traits<T>::is_signed) {
+        if (ptr != end && *ptr == '-') {
+            negative = true;
+            ptr++;
+        }
+    }
+    const char* digits = ptr;
+
+    // Up to safe_end no digit can overflow, so the fast loops don't need to
+    // check, and a checked loop picks up anything longer than that
+    const char* safe_end = digits + std::min<size_t>(static_cast<size_t>(end - digits), safe_digits<U>());
+    U value = 0;
+    if (std::endian::native == std::endian::little && !std::is_constant_evaluated()) {
+        while (safe_end - ptr >= 8) {
+            uint64_t chunk = load_chunk(ptr);
+            if (!is_eight_digits(chunk)) break;
+            value = value * 100000000 + parse_eight_digits(chunk);
+            ptr += 8;
+        }
+    }
+    while (ptr != safe_end && static_cast<unsigned char>(*ptr - '0') < 10) {
+        value = value * 10 + static_cast<U>(*ptr - '0');
+        ptr++;
+    }
+    while (ptr != end && static_cast<unsigned char>(*ptr - '0') < 10) {
+        U shifted = 0;
+        if (__builtin_mul_overflow(value, static_cast<U>(10), &shifted) ||
+            __builtin_add_overflow(shifted, static_cast<U>(*ptr - '0'), &value)) {
+            throw_parse_error(original, true);
+        }
+        ptr++;
+    }
+    if (ptr == digits) {
+        throw_parse_error(original, false);
+    }
+    text.remove_prefix(static_cast<size_t>(ptr - text.data()));
+
+    if constexpr (int_traits<T>::is_signed) {
+        const U limit = static_cast<U>(std::numeric_limits<T>::max()) + (negative ? 1 : 0);
+        if (value > limit) {
+            throw_parse_error(original, true);
+        }
+        return negative ? static_cast<T>(U(0) - value) : static_cast<T>(value);
+    }
+    else {
+        return value;
+    }
+}
+
+// SWAR parse of the number at the front of a field
+template <typename T>
+constexpr T parse_int(std::string_view text) {
+    return consume_int<T>(text);
+}
+
+// Reference parse through std::from_chars (no 128-bit support)
+template <typename T>
+T parse_int_fc(std::string_view text) {
+    T value = 0;
+    auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc()) {
+        throw_parse_error(text, ec == std::errc::result_out_of_range);
+    }
+    return value;
+}
+
+// Splits at the first delimiter, the second half is empty if there is none
+constexpr std::pair<std::string_view, std::string_view> split_pair(std::string_view text, char delim) {
+    size_t idx = text.find(delim);
+    if (idx == std::string_view::npos) {
+        return {text, {}};
+    }
+    return {text.substr(0, idx), text.substr(idx + 1)};
+}
+
+// Parses exactly N delimiter separated integers, e.g. "162,817,812"
+template <typename T, size_t N>
+constexpr std::array<T, N> parse_fields(std::string_view text, char delim) {
+    std::array<T, N> values;
+    for (size_t ii=0; ii<N; ii++) {
+        values[ii] = consume_int<T>(text);
+        if (ii < N - 1) {
+            if (text.empty() || text.front() != delim) {
+                throw_parse_error(text, false);
+            }
+            text.remove_prefix(1);
+        }
+    }
+    return values;
+}
+
+// Parses a dash separated range such as "3-5"
+template <typename T>
+constexpr std::array<T, 2> parse_range(std::string_view text) {
+    return parse_fields<T, 2>(text, '-');
+}
+
+} // namespace aoc
@@ -0,0 +1,123 @@
+// Hardware performance counters for the benchmark harness
+//
+// Reads Linux perf_event_open counters (cycles, instructions, L1D and LLC read
+// misses, branch misses) for the calling thread, and any thread it starts
+// while they run, in user space only. Each counter is opened on its own, so a
+// CPU or VM without one of them still gets the rest, and when none can be
+// opened, e.g. no PMU or perf_event_paranoid too high, available() is false
+// and the harness reports timings only. Counts are scaled up when the kernel
+// had to multiplex the counters.
+//
+// AOC_BENCH_PERF=0 turns the counters off.
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string_view>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace aoc::perf {
+
+enum Counter {
+    cycles,
+    instructions,
+    l1d_misses,
+    llc_misses,
+    branch_misses,
+    COUNTER_COUNT,
+};
+
+constexpr std::array<const char*, COUNTER_COUNT> counter_names = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses",
+};
+
+// Counts for one measurement, valid is false for counters that could not be read
+struct Reading {
+    std::array<uint64_t, COUNTER_COUNT> values = {};
+    std::array<bool, COUNTER_COUNT> valid = {};
+};
+
+class Counters {
+public:
+    Counters() {
+        const char* setting = std::getenv("AOC_BENCH_PERF");
+        if (setting != nullptr && std::string_view(setting) == "0") return;
+        const uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D |
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const uint64_t llc_read_miss = PERF_COUNT_HW_CACHE_LL |
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        fds_[cycles] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        fds_[instructions] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        fds_[l1d_misses] = open(PERF_TYPE_HW_CACHE, l1d_read_miss);
+        fds_[llc_misses] = open(PERF_TYPE_HW_CACHE, llc_read_miss);
+        fds_[branch_misses] = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    }
+
+    ~Counters() {
+        for (int fd : fds_) {
+            if (fd >= 0) ::close(fd);
+        }
+    }
+
+    Counters(const Counters&) = delete;
+    Counters& operator=(const Counters&) = delete;
+
+    bool available() const {
+        for (int fd : fds_) {
+            if (fd >= 0) return true;
+        }
+        return false;
+    }
+
+    // Zeroes and starts every counter
+    void start() {
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    // Stops the counters and returns what they counted since start
+    Reading stop() {
+        for (int fd : fds_) {
+            if (fd >= 0) ::ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+        Reading reading;
+        for (size_t ii=0; ii<COUNTER_COUNT; ii++) {
+            if (fds_[ii] < 0) continue;
+            // value, time enabled, time running
+            uint64_t data[3];
+            if (::read(fds_[ii], data, sizeof(data)) != static_cast<ssize_t>(sizeof(data))) continue;
+            double scale = (data[2] > 0 && data[2] < data[1]) ? static_cast<double>(data[1]) / static_cast<double>(data[2]) : 1.0;
+            reading.values[ii] = static_cast<uint64_t>(static_cast<double>(data[0]) * scale);
+            reading.valid[ii] = data[2] > 0;
+        }
+        return reading;
+    }
+
+private:
+    static int open(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+    }
+
+    std::array<int, COUNTER_COUNT> fds_ = {-1, -1, -1, -1, -1};
+};
+
+} // namespace aoc::perf
@@ -0,0 +1,121 @@
+// Points as a structure of arrays, and a tiled walk over all their pairs
+//
+// Points<T, Dims> keeps each coordinate in an array of its own, x of every
+// point, then y, then z, each starting on a cache line, so a run of points
+// is a run of vectors per coordinate for the kernels in aoc/simd.h.
+//
+// for_each_pair_tile visits every pair ii < jj of count points as rows of
+// the points jj in [begin, end) against one ii, a tile of PAIR_TILE points
+// jj at a time: every ii up to the end of the tile is run against it before
+// moving to the next, so the tile's coordinates stay in L1 however many
+// points there are, while the ii stream through one coordinate each. The
+// pairs are not visited in order, but pair_offset(count, ii) + jj - ii - 1
+// is where (ii, jj) goes in a list of them ordered by ii and then jj, so
+// results written there come out in that order anyway.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <span>
+#include <vector>
+
+namespace aoc {
+
+// Allocates on Align byte boundaries
+template <typename T, size_t Align>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Align>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Align}));
+    }
+
+    void deallocate(T* data, size_t) {
+        ::operator delete(data, std::align_val_t{Align});
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+};
+
+template <typename T, size_t Dims>
+class Points {
+public:
+    using Point = std::array<T, Dims>;
+    static constexpr size_t ALIGN = 64;
+
+    Points() = default;
+
+    explicit Points(std::span<const Point> points)
+        : size_(points.size()), stride_(padded(points.size())), coords_(Dims * stride_) {
+        for (size_t ii=0; ii<size_; ii++) {
+            for (size_t dim=0; dim<Dims; dim++) {
+                coords_[dim * stride_ + ii] = points[ii][dim];
+            }
+        }
+    }
+
+    size_t size() const { return size_; }
+
+    // Coordinate dim of every point, ALIGN byte aligned
+    const T* coord(size_t dim) const { return coords_.data() + dim * stride_; }
+
+    Point operator[](size_t ii) const {
+        Point point;
+        for (size_t dim=0; dim<Dims; dim++) {
+            point[dim] = coords_[dim * stride_ + ii];
+        }
+        return point;
+    }
+
+private:
+    // Enough values for count points rounded up to whole cache lines
+    static size_t padded(size_t count) {
+        constexpr size_t per_line = ALIGN / sizeof(T);
+        return (count + per_line - 1) / per_line * per_line;
+    }
+
+    size_t size_ = 0;
+    size_t stride_ = 0;
+    std::vector<T, AlignedAllocator<T, ALIGN>> coords_;
+};
+
+// Points jj per tile, 512 make 12 KiB of three 8 byte coordinates
+constexpr size_t PAIR_TILE = 512;
+
+// Pairs ii < jj among count points
+constexpr size_t pair_count(size_t count) {
+    return count < 2 ? 0 : count * (count - 1) / 2;
+}
+
+// Pairs before the first one of ii, with the pairs ordered by ii then jj
+constexpr size_t pair_offset(size_t count, size_t ii) {
+    return ii * (2 * count - ii - 1) / 2;
+}
+
+// Calls row(ii, begin, end) so that every pair ii < jj of count points is in
+// exactly one call with jj in [begin, end), tile by tile
+template <typename Row>
+void for_each_pair_tile(size_t count, Row&& row, size_t tile = PAIR_TILE) {
+    for (size_t first=1; first<count; first+=tile) {
+        size_t last = std::min(count, first + tile);
+        for (size_t ii=0; ii+1<last; ii++) {
+            size_t begin = std::max(first, ii + 1);
+            row(ii, begin, last);
+        }
+    }
+}
+
+} // namespace aoc
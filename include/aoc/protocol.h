@@ -0,0 +1,136 @@
+// Wire protocol between the solver daemon (tools/aocd.cc) and its clients
+//
+// Clients connect to a Unix stream socket and send any number of requests
+// over the one connection, each answered in order:
+//
+//   request   RequestHeader, then size bytes of puzzle input
+//   response  ResponseHeader, then size bytes of text: the answers exactly as
+//             a day's executable prints them, or an error message
+//
+// Integers are in host byte order, which is fine for a local socket. The
+// response carries the time the daemon spent on the request, from reading it
+// to having the answers, so clients can tell queueing and transport apart
+// from solving.
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace aoc::protocol {
+
+constexpr uint32_t REQUEST_MAGIC = 0x51434f41;  // "AOCQ"
+constexpr uint32_t RESPONSE_MAGIC = 0x52434f41; // "AOCR"
+
+// Anything bigger is rejected before reading it
+constexpr uint64_t MAX_INPUT_SIZE = 256ull << 20;
+
+enum class Status : uint32_t {
+    ok = 0,
+    unknown_day = 1,
+    error = 2,
+    bad_request = 3,
+};
+
+struct RequestHeader {
+    uint32_t magic;
+    uint32_t day;
+    uint64_t size;
+};
+
+struct ResponseHeader {
+    uint32_t magic;
+    Status status;
+    uint64_t server_ns;
+    uint64_t size;
+};
+
+// AOC_SOCKET, or a per-user default in /tmp
+inline std::string default_socket_path() {
+    if (const char* value = std::getenv("AOC_SOCKET")) {
+        return value;
+    }
+    return "/tmp/aocd-" + std::to_string(getuid()) + ".sock";
+}
+
+inline sockaddr_un socket_address(const std::string& path) {
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        throw std::system_error(ENAMETOOLONG, std::generic_category(), "socket path " + path);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return addr;
+}
+
+// Returns a connected socket, throws when nothing is listening
+inline int connect_to(const std::string& path) {
+    sockaddr_un addr = socket_address(path);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), "connect " + path);
+    }
+    return fd;
+}
+
+// Both return false on error or when the peer closed the connection
+inline bool write_all(int fd, const void* data, size_t size) {
+    const char* pos = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::send(fd, pos, size, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        pos += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+inline bool read_all(int fd, void* data, size_t size) {
+    char* pos = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t got = ::recv(fd, pos, size, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        pos += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+// Reads a payload of size bytes into buffer, which keeps its capacity so a
+// connection's buffer stops reallocating once it has seen its largest input
+inline bool read_payload(int fd, uint64_t size, std::string& buffer) {
+    buffer.resize(size);
+    return read_all(fd, buffer.data(), size);
+}
+
+inline bool send_request(int fd, uint32_t day, std::string_view input) {
+    RequestHeader header = {REQUEST_MAGIC, day, input.size()};
+    return write_all(fd, &header, sizeof(header)) && write_all(fd, input.data(), input.size());
+}
+
+inline bool send_response(int fd, Status status, uint64_t server_ns, std::string_view text) {
+    ResponseHeader header = {RESPONSE_MAGIC, status, server_ns, text.size()};
+    return write_all(fd, &header, sizeof(header)) && write_all(fd, text.data(), text.size());
+}
+
+inline bool read_response(int fd, ResponseHeader& header, std::string& text) {
+    if (!read_all(fd, &header, sizeof(header)) || header.magic != RESPONSE_MAGIC) return false;
+    return read_payload(fd, header.size, text);
+}
+
+} // namespace aoc::protocol
@@ -0,0 +1,43 @@
+// Every day, in order, for the programs that run more than one of them
+//
+// Including this pulls in all of the days, so anything that does has to be
+// linked against the whole of libaoc.a.
+#pragma once
+
+#include <vector>
+
+#include "aoc/day.h"
+
+namespace day1 { extern const aoc::Day day; }
+namespace day2 { extern const aoc::Day day; }
+namespace day3 { extern const aoc::Day day; }
+namespace day4 { extern const aoc::Day day; }
+namespace day5 { extern const aoc::Day day; }
+namespace day6 { extern const aoc::Day day; }
+namespace day7 { extern const aoc::Day day; }
+namespace day8 { extern const aoc::Day day; }
+namespace day9 { extern const aoc::Day day; }
+namespace day10 { extern const aoc::Day day; }
+namespace day11 { extern const aoc::Day day; }
+namespace day12 { extern const aoc::Day day; }
+
+namespace aoc {
+
+inline const std::vector<const Day*>& days() {
+    static const std::vector<const Day*> all = {
+        &day1::day, &day2::day, &day3::day, &day4::day,
+        &day5::day, &day6::day, &day7::day, &day8::day,
+        &day9::day, &day10::day, &day11::day, &day12::day,
+    };
+    return all;
+}
+
+// Returns nullptr for a day that does not exist
+inline const Day* find_day(int number) {
+    for (const Day* day : days()) {
+        if (day->number == number) return day;
+    }
+    return nullptr;
+}
+
+} // namespace aoc
@@ -0,0 +1,195 @@
+// Sampling profiler for the profile build (make profile)
+//
+// Include from exactly one translation unit of each program, the one with
+// main. Without -DAOC_PROFILE this is empty. In a profile build, setting
+// AOC_PROFILE_OUT to a file name makes the program sample its own call
+// stacks while it runs and write them there when it exits, for
+// tools/fold_stacks.cc to fold into a flame graph. make profile uses it
+// where perf is not installed or not allowed.
+//
+// A SIGPROF timer on the CPU time of the process fires AOC_PROFILE_HZ times a
+// second (default 999, in practice at most once per kernel tick) in whichever
+// thread is running. The handler walks the frame pointer chain up from the
+// interrupted instruction, which the profile build keeps in every function it
+// compiles. The frames are read with process_vm_readv, so a chain that goes
+// wrong in a library built without frame pointers ends there rather than
+// faulting. Samples go into a buffer allocated up front, and those that no
+// longer fit are counted and dropped.
+//
+// The file has a line per sample, innermost frame first: addresses in the
+// executable as hex offsets from where it was loaded, for fold_stacks to look
+// up with addr2line, and frames in shared libraries as library:symbol.
+#pragma once
+
+#ifdef AOC_PROFILE
+
+#ifndef __x86_64__
+#error "aoc/sampler.h only walks x86-64 frames"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <link.h>
+#include <signal.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "aoc/output.h"
+
+namespace aoc::sampler {
+
+constexpr size_t MAX_DEPTH = 128;
+
+// Each sample takes its depth and then its frames, 32 MiB in all
+constexpr size_t BUFFER_WORDS = size_t{1} << 22;
+
+inline uintptr_t* buffer = nullptr;
+inline std::atomic<size_t> used{0};
+inline std::atomic<size_t> dropped{0};
+
+// The caller's frame pointer and the return address at a frame pointer,
+// false if they can't be read
+inline bool read_frame(uintptr_t fp, uintptr_t (&frame)[2]) {
+    iovec local = {frame, sizeof(frame)};
+    iovec remote = {reinterpret_cast<void*>(fp), sizeof(frame)};
+    return process_vm_readv(getpid(), &local, 1, &remote, 1, 0) == static_cast<ssize_t>(sizeof(frame));
+}
+
+inline void on_sample(int, siginfo_t*, void* context) {
+    int saved_errno = errno;
+    const mcontext_t& registers = static_cast<const ucontext_t*>(context)->uc_mcontext;
+    uintptr_t frames[MAX_DEPTH];
+    size_t depth = 0;
+    frames[depth++] = static_cast<uintptr_t>(registers.gregs[REG_RIP]);
+    uintptr_t fp = static_cast<uintptr_t>(registers.gregs[REG_RBP]);
+    uintptr_t sp = static_cast<uintptr_t>(registers.gregs[REG_RSP]);
+    // Every frame is further up the stack than the one it called
+    while (depth < MAX_DEPTH && fp >= sp && fp % sizeof(uintptr_t) == 0) {
+        uintptr_t frame[2];
+        if (!read_frame(fp, frame) || frame[1] == 0) break;
+        frames[depth++] = frame[1];
+        sp = fp + sizeof(frame);
+        fp = frame[0];
+    }
+
+    size_t start = used.fetch_add(depth + 1, std::memory_order_relaxed);
+    if (start + depth + 1 > BUFFER_WORDS) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    else {
+        std::copy(frames, frames + depth, buffer + start + 1);
+        buffer[start] = depth;
+    }
+    errno = saved_errno;
+}
+
+// Where the executable was loaded, the first object dl_iterate_phdr reports
+inline uintptr_t executable_bias() {
+    uintptr_t bias = 0;
+    dl_iterate_phdr([](dl_phdr_info* info, size_t, void* data) {
+        *static_cast<uintptr_t*>(data) = info->dlpi_addr;
+        return 1;
+    }, &bias);
+    return bias;
+}
+
+inline void append_hex(std::string& out, uintptr_t value) {
+    char digits[20];
+    out += "0x";
+    out.append(digits, std::to_chars(digits, digits + sizeof(digits), value, 16).ptr);
+}
+
+// The buffer as text, one line per sample
+inline std::string format_samples() {
+    uintptr_t bias = executable_bias();
+    Dl_info self;
+    dladdr(reinterpret_cast<void*>(&on_sample), &self);
+
+    std::string text = "# aoc samples, dropped ";
+    append_int(text, dropped.load());
+    text += "\n";
+    size_t end = std::min(used.load(), BUFFER_WORDS);
+    for (size_t pos=0; pos<end && buffer[pos]!=0; pos+=buffer[pos]+1) {
+        size_t depth = buffer[pos];
+        if (pos + depth + 1 > end) break;
+        for (size_t ii=0; ii<depth; ii++) {
+            // Return addresses point after the call, back up into it
+            uintptr_t address = buffer[pos+1+ii] - (ii > 0 ? 1 : 0);
+            Dl_info info;
+            if (ii > 0) text += " ";
+            if (dladdr(reinterpret_cast<void*>(address), &info) == 0 || info.dli_fbase == self.dli_fbase) {
+                append_hex(text, address - bias);
+                continue;
+            }
+            std::string_view library = info.dli_fname ? info.dli_fname : "?";
+            text += library.substr(library.rfind('/') + 1);
+            if (info.dli_sname) {
+                text += ":";
+                text += info.dli_sname;
+            }
+        }
+        text += "\n";
+    }
+    return text;
+}
+
+// Samples from construction to destruction when AOC_PROFILE_OUT is set
+class Session {
+public:
+    Session() {
+        const char* path = std::getenv("AOC_PROFILE_OUT");
+        if (path == nullptr || *path == '\0') return;
+        path_ = path;
+        long hz = 999;
+        if (const char* value = std::getenv("AOC_PROFILE_HZ")) {
+            hz = std::clamp(std::strtol(value, nullptr, 10), 1L, 100000L);
+        }
+        buffer = new uintptr_t[BUFFER_WORDS]();
+
+        struct sigaction action = {};
+        action.sa_sigaction = on_sample;
+        action.sa_flags = SA_SIGINFO | SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGPROF, &action, nullptr);
+        itimerval timer = {};
+        timer.it_interval.tv_sec = hz == 1 ? 1 : 0;
+        timer.it_interval.tv_usec = hz == 1 ? 0 : 1000000 / hz;
+        timer.it_value = timer.it_interval;
+        setitimer(ITIMER_PROF, &timer, nullptr);
+    }
+
+    ~Session() {
+        if (path_.empty()) return;
+        itimerval off = {};
+        setitimer(ITIMER_PROF, &off, nullptr);
+        signal(SIGPROF, SIG_IGN);
+
+        int fd = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || !write_all(fd, format_samples())) {
+            write_all(STDERR_FILENO, "Unable to write samples to " + path_ + "\n");
+        }
+        if (fd >= 0) ::close(fd);
+    }
+
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+
+private:
+    std::string path_;
+};
+
+inline Session session;
+
+} // namespace aoc::sampler
+
+#endif // AOC_PROFILE
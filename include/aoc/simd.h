@@ -0,0 +1,357 @@
+// SIMD kernels with the instruction set picked at run time
+//
+// Each kernel is written once, in aoc/simd_kernels.h, against a handful of
+// vector operations (struct Ops), and compiled for every x86 level by
+// including that file under a #pragma GCC target with the level's own Ops.
+// The first call to kernels() checks what the CPU supports and picks the
+// table of the best level, so a binary built without -march=native runs the
+// AVX-512 kernels where they exist and the AVX2, SSE4.1 or scalar ones
+// elsewhere. AOC_SIMD=scalar, sse4, avx2 or avx512 caps the level, e.g. to
+// compare levels on one machine, but a level the CPU lacks is never picked.
+//
+// Every level gives the same results as the scalar kernels, which
+// bench/simd.cc checks (make bench-simd) for every level the CPU has.
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AOC_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace aoc::simd {
+
+enum class Level {
+    scalar,
+    sse4,
+    avx2,
+    avx512,
+};
+
+constexpr const char* level_names[] = {"scalar", "sse4", "avx2", "avx512"};
+
+inline const char* level_name(Level level) {
+    return level_names[static_cast<size_t>(level)];
+}
+
+// The best level this CPU, and the OS, supports
+inline Level supported_level() {
+#ifdef AOC_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq")) {
+        return Level::avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) return Level::avx2;
+    if (__builtin_cpu_supports("sse4.1")) return Level::sse4;
+#endif
+    return Level::scalar;
+}
+
+// The supported level, capped by AOC_SIMD
+inline Level selected_level() {
+    Level level = supported_level();
+    if (const char* setting = std::getenv("AOC_SIMD")) {
+        for (size_t ii=0; ii<std::size(level_names); ii++) {
+            if (std::string_view(setting) == level_names[ii]) {
+                level = std::min(level, static_cast<Level>(ii));
+            }
+        }
+    }
+    return level;
+}
+
+struct Kernels {
+    // Index of the first largest byte in data[0, size), 0 when size is 0
+    size_t (*first_max)(const uint8_t* data, size_t size);
+
+    // Day 4: the '@' in row with fewer than four '@' among their eight
+    // neighbours, in a grid of rows of width bytes with a border of one that
+    // holds no '@' (an aoc::Grid), so there is always a row above and below
+    // and a cell either side of the row. count_accessible only counts them.
+    // remove_accessible also replaces each with an 'x' as it goes, and a cell
+    // may or may not see the removals just to its left depending on the level,
+    // so only the total once nothing more can be removed is the same.
+    size_t (*count_accessible)(const char* above, const char* row, const char* below, size_t width);
+    size_t (*remove_accessible)(const char* above, char* row, const char* below, size_t width);
+
+    // Day 8: out[ii] is the squared distance, modulo 2^64 like the scalar
+    // one, from (x, y, z) to (xs[ii], ys[ii], zs[ii]) for ii in [0, count)
+    void (*squared_distances)(const uint64_t* xs, const uint64_t* ys, const uint64_t* zs, size_t count,
+                              uint64_t x, uint64_t y, uint64_t z, uint64_t* out);
+
+    // Day 9: out[ii] is (|xs[ii] - x| + 1) * (|ys[ii] - y| + 1), the area of
+    // the rectangle with corners (x, y) and (xs[ii], ys[ii]) counted in whole
+    // tiles, modulo 2^64 like the scalar one, for ii in [0, count)
+    void (*rect_areas)(const int64_t* xs, const int64_t* ys, size_t count, int64_t x, int64_t y, int64_t* out);
+};
+
+namespace scalar {
+
+inline size_t first_max(const uint8_t* data, size_t size) {
+    size_t index = 0;
+    for (size_t ii=1; ii<size; ii++) {
+        if (data[ii] > data[index]) index = ii;
+    }
+    return index;
+}
+
+// Whether the '@' at row[xx] has fewer than four neighbouring ones, the
+// border makes all eight of them readable
+inline bool accessible(const char* above, const char* row, const char* below, size_t xx) {
+    const char* up = above + xx;
+    const char* cell = row + xx;
+    const char* down = below + xx;
+    int nearby_count = (up[-1] == '@') + (up[0] == '@') + (up[1] == '@') +
+                       (cell[-1] == '@') + (cell[1] == '@') +
+                       (down[-1] == '@') + (down[0] == '@') + (down[1] == '@');
+    return nearby_count < 4;
+}
+
+// Checks the cells in [begin, end) for the kernels below, which also use it
+// for rows narrower than a vector
+template <bool Remove, typename Row>
+size_t accessible_range(const char* above, Row* row, const char* below, size_t begin, size_t end) {
+    size_t count = 0;
+    for (size_t xx=begin; xx<end; xx++) {
+        if (row[xx] != '@' || !accessible(above, row, below, xx)) continue;
+        count++;
+        if constexpr (Remove) row[xx] = 'x';
+    }
+    return count;
+}
+
+inline size_t count_accessible(const char* above, const char* row, const char* below, size_t width) {
+    return accessible_range<false>(above, row, below, 0, width);
+}
+
+inline size_t remove_accessible(const char* above, char* row, const char* below, size_t width) {
+    return accessible_range<true>(above, row, below, 0, width);
+}
+
+inline void squared_distances(const uint64_t* xs, const uint64_t* ys, const uint64_t* zs, size_t count,
+                              uint64_t x, uint64_t y, uint64_t z, uint64_t* out) {
+    for (size_t ii=0; ii<count; ii++) {
+        uint64_t dx = xs[ii] - x;
+        uint64_t dy = ys[ii] - y;
+        uint64_t dz = zs[ii] - z;
+        out[ii] = dx*dx + dy*dy + dz*dz;
+    }
+}
+
+// In unsigned arithmetic, so the wrap around is defined and matches the vectors
+inline void rect_areas(const int64_t* xs, const int64_t* ys, size_t count, int64_t x, int64_t y, int64_t* out) {
+    for (size_t ii=0; ii<count; ii++) {
+        uint64_t dx = static_cast<uint64_t>(xs[ii]) - static_cast<uint64_t>(x);
+        uint64_t dy = static_cast<uint64_t>(ys[ii]) - static_cast<uint64_t>(y);
+        uint64_t w = (static_cast<int64_t>(dx) < 0 ? 0 - dx : dx) + 1;
+        uint64_t h = (static_cast<int64_t>(dy) < 0 ? 0 - dy : dy) + 1;
+        out[ii] = static_cast<int64_t>(w * h);
+    }
+}
+
+} // namespace scalar
+
+#ifdef AOC_SIMD_X86
+
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+namespace sse4 {
+
+struct Ops {
+    using Vec = __m128i;
+    static constexpr size_t bytes = 16;
+
+    static Vec load(const void* from) { return _mm_loadu_si128(static_cast<const Vec*>(from)); }
+    static void store(void* to, Vec value) { _mm_storeu_si128(static_cast<Vec*>(to), value); }
+    static Vec zero() { return _mm_setzero_si128(); }
+    static Vec splat8(char value) { return _mm_set1_epi8(value); }
+    static Vec splat64(uint64_t value) { return _mm_set1_epi64x(static_cast<int64_t>(value)); }
+    static Vec bit_and(Vec a, Vec b) { return _mm_and_si128(a, b); }
+
+    // Byte lanes, comparisons give all ones or all zeros per lane
+    static Vec eq8(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+    static Vec gt8(Vec a, Vec b) { return _mm_cmpgt_epi8(a, b); }
+    static Vec add8(Vec a, Vec b) { return _mm_add_epi8(a, b); }
+    static Vec max_u8(Vec a, Vec b) { return _mm_max_epu8(a, b); }
+    static uint8_t largest_u8(Vec a) {
+        a = _mm_max_epu8(a, _mm_srli_si128(a, 8));
+        a = _mm_max_epu8(a, _mm_srli_si128(a, 4));
+        a = _mm_max_epu8(a, _mm_srli_si128(a, 2));
+        a = _mm_max_epu8(a, _mm_srli_si128(a, 1));
+        return static_cast<uint8_t>(_mm_cvtsi128_si32(a));
+    }
+    static Vec select8(Vec mask, Vec if_set, Vec if_clear) { return _mm_blendv_epi8(if_clear, if_set, mask); }
+    static uint64_t mask8(Vec mask) { return static_cast<uint32_t>(_mm_movemask_epi8(mask)); }
+
+    // 64 bit lanes. There is no 64 bit multiply below AVX-512, so the square
+    // is lo*lo + 2*lo*hi << 32 from 32 bit multiplies, and a product is
+    // lo*lo + (lo*hi + hi*lo) << 32. Neither is there a 64 bit shift or
+    // compare for the sign, so abs64 copies the sign of the high half across
+    // the lane.
+    static Vec add64(Vec a, Vec b) { return _mm_add_epi64(a, b); }
+    static Vec sub64(Vec a, Vec b) { return _mm_sub_epi64(a, b); }
+    static Vec square64(Vec a) {
+        return _mm_add_epi64(_mm_mul_epu32(a, a), _mm_slli_epi64(_mm_mul_epu32(a, _mm_srli_epi64(a, 32)), 33));
+    }
+    static Vec mul64(Vec a, Vec b) {
+        Vec cross = _mm_add_epi64(_mm_mul_epu32(a, _mm_srli_epi64(b, 32)), _mm_mul_epu32(_mm_srli_epi64(a, 32), b));
+        return _mm_add_epi64(_mm_mul_epu32(a, b), _mm_slli_epi64(cross, 32));
+    }
+    static Vec abs64(Vec a) {
+        Vec sign = _mm_shuffle_epi32(_mm_srai_epi32(a, 31), _MM_SHUFFLE(3, 3, 1, 1));
+        return _mm_sub_epi64(_mm_xor_si128(a, sign), sign);
+    }
+};
+
+#include "aoc/simd_kernels.h"
+
+} // namespace sse4
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+namespace avx2 {
+
+struct Ops {
+    using Vec = __m256i;
+    static constexpr size_t bytes = 32;
+
+    static Vec load(const void* from) { return _mm256_loadu_si256(static_cast<const Vec*>(from)); }
+    static void store(void* to, Vec value) { _mm256_storeu_si256(static_cast<Vec*>(to), value); }
+    static Vec zero() { return _mm256_setzero_si256(); }
+    static Vec splat8(char value) { return _mm256_set1_epi8(value); }
+    static Vec splat64(uint64_t value) { return _mm256_set1_epi64x(static_cast<int64_t>(value)); }
+    static Vec bit_and(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+
+    static Vec eq8(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+    static Vec gt8(Vec a, Vec b) { return _mm256_cmpgt_epi8(a, b); }
+    static Vec add8(Vec a, Vec b) { return _mm256_add_epi8(a, b); }
+    static Vec max_u8(Vec a, Vec b) { return _mm256_max_epu8(a, b); }
+    static uint8_t largest_u8(Vec a) {
+        __m128i half = _mm_max_epu8(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+        half = _mm_max_epu8(half, _mm_srli_si128(half, 8));
+        half = _mm_max_epu8(half, _mm_srli_si128(half, 4));
+        half = _mm_max_epu8(half, _mm_srli_si128(half, 2));
+        half = _mm_max_epu8(half, _mm_srli_si128(half, 1));
+        return static_cast<uint8_t>(_mm_cvtsi128_si32(half));
+    }
+    static Vec select8(Vec mask, Vec if_set, Vec if_clear) { return _mm256_blendv_epi8(if_clear, if_set, mask); }
+    static uint64_t mask8(Vec mask) { return static_cast<uint32_t>(_mm256_movemask_epi8(mask)); }
+
+    static Vec add64(Vec a, Vec b) { return _mm256_add_epi64(a, b); }
+    static Vec sub64(Vec a, Vec b) { return _mm256_sub_epi64(a, b); }
+    static Vec square64(Vec a) {
+        return _mm256_add_epi64(_mm256_mul_epu32(a, a), _mm256_slli_epi64(_mm256_mul_epu32(a, _mm256_srli_epi64(a, 32)), 33));
+    }
+    static Vec mul64(Vec a, Vec b) {
+        Vec cross = _mm256_add_epi64(_mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)), _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b));
+        return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+    }
+    static Vec abs64(Vec a) {
+        Vec sign = _mm256_shuffle_epi32(_mm256_srai_epi32(a, 31), _MM_SHUFFLE(3, 3, 1, 1));
+        return _mm256_sub_epi64(_mm256_xor_si256(a, sign), sign);
+    }
+};
+
+#include "aoc/simd_kernels.h"
+
+} // namespace avx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw,avx512dq")
+namespace avx512 {
+
+// Comparisons give mask registers, which are turned back into vectors so the
+// kernels see the same all ones lanes as at the other levels
+struct Ops {
+    using Vec = __m512i;
+    static constexpr size_t bytes = 64;
+
+    static Vec load(const void* from) { return _mm512_loadu_si512(from); }
+    static void store(void* to, Vec value) { _mm512_storeu_si512(to, value); }
+    static Vec zero() { return _mm512_setzero_si512(); }
+    static Vec splat8(char value) { return _mm512_set1_epi8(value); }
+    static Vec splat64(uint64_t value) { return _mm512_set1_epi64(static_cast<int64_t>(value)); }
+    static Vec bit_and(Vec a, Vec b) { return _mm512_and_si512(a, b); }
+
+    static Vec eq8(Vec a, Vec b) { return _mm512_movm_epi8(_mm512_cmpeq_epi8_mask(a, b)); }
+    static Vec gt8(Vec a, Vec b) { return _mm512_movm_epi8(_mm512_cmpgt_epi8_mask(a, b)); }
+    static Vec add8(Vec a, Vec b) { return _mm512_add_epi8(a, b); }
+    static Vec max_u8(Vec a, Vec b) { return _mm512_max_epu8(a, b); }
+    static uint8_t largest_u8(Vec a) {
+        // Zero masked extracts, as GCC 12 warns about the undefined vector
+        // that the plain extract and the cast start from
+        __m256i half = _mm256_max_epu8(_mm512_maskz_extracti64x4_epi64(0xf, a, 0), _mm512_maskz_extracti64x4_epi64(0xf, a, 1));
+        __m128i quarter = _mm_max_epu8(_mm256_castsi256_si128(half), _mm256_extracti128_si256(half, 1));
+        quarter = _mm_max_epu8(quarter, _mm_srli_si128(quarter, 8));
+        quarter = _mm_max_epu8(quarter, _mm_srli_si128(quarter, 4));
+        quarter = _mm_max_epu8(quarter, _mm_srli_si128(quarter, 2));
+        quarter = _mm_max_epu8(quarter, _mm_srli_si128(quarter, 1));
+        return static_cast<uint8_t>(_mm_cvtsi128_si32(quarter));
+    }
+    static Vec select8(Vec mask, Vec if_set, Vec if_clear) { return _mm512_mask_blend_epi8(_mm512_movepi8_mask(mask), if_clear, if_set); }
+    static uint64_t mask8(Vec mask) { return _mm512_movepi8_mask(mask); }
+
+    static Vec add64(Vec a, Vec b) { return _mm512_add_epi64(a, b); }
+    static Vec sub64(Vec a, Vec b) { return _mm512_sub_epi64(a, b); }
+    static Vec square64(Vec a) { return _mm512_mullo_epi64(a, a); }
+    static Vec mul64(Vec a, Vec b) { return _mm512_mullo_epi64(a, b); }
+    // Zero masked for the same GCC 12 warning as largest_u8
+    static Vec abs64(Vec a) { return _mm512_maskz_abs_epi64(0xff, a); }
+};
+
+#include "aoc/simd_kernels.h"
+
+} // namespace avx512
+#pragma GCC pop_options
+
+#endif // AOC_SIMD_X86
+
+// The kernels of one level, which has to be supported
+inline const Kernels& kernels(Level level) {
+    static constexpr Kernels tables[] = {
+        {scalar::first_max, scalar::count_accessible, scalar::remove_accessible, scalar::squared_distances, scalar::rect_areas},
+#ifdef AOC_SIMD_X86
+        {sse4::first_max, sse4::count_accessible, sse4::remove_accessible, sse4::squared_distances, sse4::rect_areas},
+        {avx2::first_max, avx2::count_accessible, avx2::remove_accessible, avx2::squared_distances, avx2::rect_areas},
+        {avx512::first_max, avx512::count_accessible, avx512::remove_accessible, avx512::squared_distances, avx512::rect_areas},
+#endif
+    };
+    return tables[static_cast<size_t>(level)];
+}
+
+// The kernels of the selected level, picked on first use
+inline const Kernels& kernels() {
+    static const Kernels& selected = kernels(selected_level());
+    return selected;
+}
+
+inline size_t first_max(const uint8_t* data, size_t size) {
+    return kernels().first_max(data, size);
+}
+
+inline size_t count_accessible(const char* above, const char* row, const char* below, size_t width) {
+    return kernels().count_accessible(above, row, below, width);
+}
+
+inline size_t remove_accessible(const char* above, char* row, const char* below, size_t width) {
+    return kernels().remove_accessible(above, row, below, width);
+}
+
+inline void squared_distances(const uint64_t* xs, const uint64_t* ys, const uint64_t* zs, size_t count,
+                              uint64_t x, uint64_t y, uint64_t z, uint64_t* out) {
+    kernels().squared_distances(xs, ys, zs, count, x, y, z, out);
+}
+
+inline void rect_areas(const int64_t* xs, const int64_t* ys, size_t count, int64_t x, int64_t y, int64_t* out) {
+    kernels().rect_areas(xs, ys, count, x, y, out);
+}
+
+} // namespace aoc::simd
@@ -0,0 +1,120 @@
+// Kernel bodies shared by every SIMD level, see aoc/simd.h
+//
+// Deliberately without #pragma once: aoc/simd.h includes this once per level,
+// inside that level's namespace and #pragma GCC target, after defining the
+// level's Ops. Everything here is written against Ops. What is left over at
+// the end is done with one more vector that overlaps the last full one where
+// that is cheap to get right, and with the scalar kernels otherwise.
+
+inline size_t first_max(const uint8_t* data, size_t size) {
+    using Vec = Ops::Vec;
+    constexpr size_t bytes = Ops::bytes;
+
+    if (size < bytes) return scalar::first_max(data, size);
+
+    // Largest byte anywhere, the last vector ends at the last byte
+    Vec top = Ops::load(data + size - bytes);
+    for (size_t ii=0; ii+bytes<=size; ii+=bytes) {
+        top = Ops::max_u8(top, Ops::load(data + ii));
+    }
+    uint8_t largest = Ops::largest_u8(top);
+
+    // Where it first shows up. Whatever the last vector shares with the ones
+    // before it was already searched, so its first match is still the first.
+    Vec wanted = Ops::splat8(static_cast<char>(largest));
+    size_t ii = 0;
+    for (; ii+bytes<=size; ii+=bytes) {
+        uint64_t found = Ops::mask8(Ops::eq8(Ops::load(data + ii), wanted));
+        if (found != 0) return ii + static_cast<size_t>(std::countr_zero(found));
+    }
+    uint64_t found = Ops::mask8(Ops::eq8(Ops::load(data + size - bytes), wanted));
+    return size - bytes + static_cast<size_t>(std::countr_zero(found));
+}
+
+// Each lane adds -1 per neighbouring '@', so a cell is accessible when its sum
+// is above -4. The border of the grid lets every vector load the cells either
+// side of it. The last vector overlaps the one before it: when counting, the
+// lanes already counted are masked off, and when removing, the cells already
+// removed are no longer rolls and the others are free to go now.
+template <bool Remove, typename Row>
+size_t accessible_rows(const char* above, Row* row, const char* below, size_t width) {
+    using Vec = Ops::Vec;
+    constexpr size_t bytes = Ops::bytes;
+    const Vec roll = Ops::splat8('@');
+    const Vec threshold = Ops::splat8(-4);
+    const Vec removed = Ops::splat8('x');
+    auto rolls = [&](const char* line) {
+        return Ops::eq8(Ops::load(line), roll);
+    };
+
+    if (width < bytes) {
+        return scalar::accessible_range<Remove>(above, row, below, 0, width);
+    }
+    size_t count = 0;
+    size_t last = width - bytes;
+    for (size_t xx=0; xx<width; xx+=bytes) {
+        // Lanes below skip were counted by the previous vector
+        size_t skip = 0;
+        if (xx > last) {
+            skip = xx - last;
+            xx = last;
+        }
+        const char* up = above + xx;
+        const char* cell = row + xx;
+        const char* down = below + xx;
+        Vec nearby = Ops::add8(Ops::add8(rolls(up - 1), rolls(up)), rolls(up + 1));
+        nearby = Ops::add8(nearby, Ops::add8(rolls(cell - 1), rolls(cell + 1)));
+        nearby = Ops::add8(nearby, Ops::add8(Ops::add8(rolls(down - 1), rolls(down)), rolls(down + 1)));
+        Vec cells = Ops::load(cell);
+        Vec accessible = Ops::bit_and(Ops::eq8(cells, roll), Ops::gt8(nearby, threshold));
+        uint64_t found = Ops::mask8(accessible);
+        if constexpr (Remove) {
+            if (found != 0) Ops::store(row + xx, Ops::select8(accessible, removed, cells));
+        }
+        else {
+            found &= ~uint64_t{0} << skip;
+        }
+        count += static_cast<size_t>(std::popcount(found));
+    }
+    return count;
+}
+
+inline size_t count_accessible(const char* above, const char* row, const char* below, size_t width) {
+    return accessible_rows<false>(above, row, below, width);
+}
+
+inline size_t remove_accessible(const char* above, char* row, const char* below, size_t width) {
+    return accessible_rows<true>(above, row, below, width);
+}
+
+inline void squared_distances(const uint64_t* xs, const uint64_t* ys, const uint64_t* zs, size_t count,
+                              uint64_t x, uint64_t y, uint64_t z, uint64_t* out) {
+    using Vec = Ops::Vec;
+    constexpr size_t lanes = Ops::bytes / sizeof(uint64_t);
+    const Vec px = Ops::splat64(x);
+    const Vec py = Ops::splat64(y);
+    const Vec pz = Ops::splat64(z);
+    size_t ii = 0;
+    for (; ii+lanes<=count; ii+=lanes) {
+        Vec dx = Ops::sub64(Ops::load(xs + ii), px);
+        Vec dy = Ops::sub64(Ops::load(ys + ii), py);
+        Vec dz = Ops::sub64(Ops::load(zs + ii), pz);
+        Ops::store(out + ii, Ops::add64(Ops::add64(Ops::square64(dx), Ops::square64(dy)), Ops::square64(dz)));
+    }
+    scalar::squared_distances(xs + ii, ys + ii, zs + ii, count - ii, x, y, z, out + ii);
+}
+
+inline void rect_areas(const int64_t* xs, const int64_t* ys, size_t count, int64_t x, int64_t y, int64_t* out) {
+    using Vec = Ops::Vec;
+    constexpr size_t lanes = Ops::bytes / sizeof(int64_t);
+    const Vec px = Ops::splat64(static_cast<uint64_t>(x));
+    const Vec py = Ops::splat64(static_cast<uint64_t>(y));
+    const Vec one = Ops::splat64(1);
+    size_t ii = 0;
+    for (; ii+lanes<=count; ii+=lanes) {
+        Vec w = Ops::add64(Ops::abs64(Ops::sub64(Ops::load(xs + ii), px)), one);
+        Vec h = Ops::add64(Ops::abs64(Ops::sub64(Ops::load(ys + ii), py)), one);
+        Ops::store(out + ii, Ops::mul64(w, h));
+    }
+    scalar::rect_areas(xs + ii, ys + ii, count - ii, x, y, out + ii);
+}
@@ -0,0 +1,61 @@
+// Chunked line reader for the streaming solvers
+//
+// stream_lines reads a file descriptor, typically stdin, a chunk at a time
+// and yields one line at a time without its newline, so a solver can start
+// folding before the input has all arrived and never holds more than a
+// chunk plus the longest line. A last line without a newline is still
+// yielded. Each line is a view into the reader's buffer, valid until the
+// next one is requested.
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include "aoc/generator.h"
+
+namespace aoc {
+
+inline Generator<std::string_view> stream_lines(int fd, size_t chunk_size = 64 << 10) {
+    std::vector<char> buffer(chunk_size);
+    size_t begin = 0;
+    size_t end = 0;
+    while (true) {
+        // Hand out every complete line in the buffer
+        const char* newline;
+        while ((newline = static_cast<const char*>(std::memchr(buffer.data() + begin, '\n', end - begin))) != nullptr) {
+            size_t length = static_cast<size_t>(newline - (buffer.data() + begin));
+            co_yield std::string_view(buffer.data() + begin, length);
+            begin += length + 1;
+        }
+
+        // Move the partial line to the front, growing the buffer only for a
+        // line longer than it, and read more after it
+        if (begin > 0) {
+            std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+            end -= begin;
+            begin = 0;
+        }
+        if (end == buffer.size()) {
+            buffer.resize(buffer.size() * 2);
+        }
+        ssize_t got = ::read(fd, buffer.data() + end, buffer.size() - end);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) {
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (got == 0) break;
+        end += static_cast<size_t>(got);
+    }
+    if (end > begin) {
+        co_yield std::string_view(buffer.data() + begin, end - begin);
+    }
+}
+
+} // namespace aoc
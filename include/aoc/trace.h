@@ -0,0 +1,225 @@
+// Hot path instrumentation
+//
+// Scoped timers, named counters and histograms that can be dropped into any
+// function to see what it is doing without printing from inside the loop:
+//
+//   AOC_TRACE_SCOPE("name")         time from here to the end of the block
+//   AOC_TRACE_COUNT("name", n)      add n to a counter
+//   AOC_TRACE_HIST("name", value)   record value in a power of two histogram
+//
+// They only exist when built with -DAOC_TRACE (make trace). Otherwise the
+// macros expand to nothing and their arguments are never evaluated, so they
+// cost nothing in the other builds.
+//
+// Each call site looks its entry up once and then only does relaxed atomic
+// updates, so the days can be traced while running concurrently in the
+// driver. Names are prefixed with the day and function by convention, e.g.
+// "day11/count_paths/cache_hits". Everything accumulates over the whole
+// process, including repeated calls in a bench build. When AOC_TRACE_JSON
+// names a file (or "-" for stdout) the totals are written there as JSON at
+// exit, otherwise trace builds run silently.
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+#include "aoc/output.h"
+
+namespace aoc::trace {
+
+#ifdef AOC_TRACE
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+inline void update_min(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+inline void update_max(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {}
+}
+
+struct Counter {
+    std::atomic<uint64_t> value{0};
+
+    void add(uint64_t n) { value.fetch_add(n, std::memory_order_relaxed); }
+};
+
+// Bucket 0 holds zeros and bucket k holds values in [2^(k-1), 2^k)
+struct Histogram {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> min{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max{0};
+    std::array<std::atomic<uint64_t>, 65> buckets{};
+
+    void record(uint64_t value) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(value, std::memory_order_relaxed);
+        update_min(min, value);
+        update_max(max, value);
+        buckets[std::bit_width(value)].fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+struct Timer {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> min_ns{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max_ns{0};
+
+    void record(uint64_t ns) {
+        calls.fetch_add(1, std::memory_order_relaxed);
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        update_min(min_ns, ns);
+        update_max(max_ns, ns);
+    }
+};
+
+class ScopedTimer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit ScopedTimer(Timer& timer) : timer_(timer), start_(Clock::now()) {}
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        timer_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start_).count());
+    }
+
+private:
+    Timer& timer_;
+    Clock::time_point start_;
+};
+
+// Every named entry in the process. Entries are never removed, and std::map
+// never moves its nodes, so call sites can hold on to the references.
+class Registry {
+public:
+    static Registry& get() {
+        static Registry registry;
+        return registry;
+    }
+
+    Counter& counter(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return counters_[name];
+    }
+
+    Histogram& histogram(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return histograms_[name];
+    }
+
+    Timer& timer(const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return timers_[name];
+    }
+
+    void write_json(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const char* sep = "";
+        out << "{\"counters\": {";
+        for (const auto& [name, counter] : counters_) {
+            out << sep << "\"" << name << "\": " << counter.value.load();
+            sep = ", ";
+        }
+        sep = "";
+        out << "}, \"timers\": {";
+        for (const auto& [name, timer] : timers_) {
+            uint64_t calls = timer.calls.load();
+            out << sep << "\"" << name << "\": {\"calls\": " << calls
+                << ", \"total_ns\": " << timer.total_ns.load()
+                << ", \"min_ns\": " << (calls ? timer.min_ns.load() : 0)
+                << ", \"max_ns\": " << timer.max_ns.load() << "}";
+            sep = ", ";
+        }
+        sep = "";
+        out << "}, \"histograms\": {";
+        for (const auto& [name, hist] : histograms_) {
+            uint64_t count = hist.count.load();
+            out << sep << "\"" << name << "\": {\"count\": " << count
+                << ", \"sum\": " << hist.sum.load()
+                << ", \"min\": " << (count ? hist.min.load() : 0)
+                << ", \"max\": " << hist.max.load() << ", \"buckets\": [";
+            const char* bucket_sep = "";
+            for (size_t ii=0; ii<hist.buckets.size(); ii++) {
+                uint64_t in_bucket = hist.buckets[ii].load();
+                if (in_bucket == 0) continue;
+                uint64_t lo = ii ? uint64_t{1} << (ii - 1) : 0;
+                uint64_t hi = ii == 0 ? 0 : ii == 64 ? std::numeric_limits<uint64_t>::max() : (uint64_t{1} << ii) - 1;
+                out << bucket_sep << "{\"lo\": " << lo << ", \"hi\": " << hi << ", \"count\": " << in_bucket << "}";
+                bucket_sep = ", ";
+            }
+            out << "]}";
+            sep = ", ";
+        }
+        out << "}}\n";
+    }
+
+private:
+    Registry() = default;
+
+    std::mutex mutex_;
+    std::map<std::string, Counter> counters_;
+    std::map<std::string, Histogram> histograms_;
+    std::map<std::string, Timer> timers_;
+};
+
+// Writes the JSON report if AOC_TRACE_JSON is set, does nothing in normal builds
+inline void report() {
+    if constexpr (enabled) {
+        const char* path = std::getenv("AOC_TRACE_JSON");
+        if (path == nullptr || *path == '\0') return;
+        if (std::string(path) == "-") {
+            std::ostringstream json;
+            Registry::get().write_json(json);
+            print(json.str());
+        }
+        else {
+            std::ofstream ofile(path);
+            Registry::get().write_json(ofile);
+        }
+    }
+}
+
+} // namespace aoc::trace
+
+#ifdef AOC_TRACE
+#define AOC_TRACE_CONCAT_(a, b) a##b
+#define AOC_TRACE_CONCAT(a, b) AOC_TRACE_CONCAT_(a, b)
+#define AOC_TRACE_SCOPE(name) \
+    static aoc::trace::Timer& AOC_TRACE_CONCAT(aoc_trace_timer_, __LINE__) = aoc::trace::Registry::get().timer(name); \
+    aoc::trace::ScopedTimer AOC_TRACE_CONCAT(aoc_trace_scope_, __LINE__)(AOC_TRACE_CONCAT(aoc_trace_timer_, __LINE__))
+#define AOC_TRACE_COUNT(name, n) \
+    do { \
+        static aoc::trace::Counter& aoc_trace_counter = aoc::trace::Registry::get().counter(name); \
+        aoc_trace_counter.add(static_cast<uint64_t>(n)); \
+    } while (0)
+#define AOC_TRACE_HIST(name, value) \
+    do { \
+        static aoc::trace::Histogram& aoc_trace_hist = aoc::trace::Registry::get().histogram(name); \
+        aoc_trace_hist.record(static_cast<uint64_t>(value)); \
+    } while (0)
+#else
+#define AOC_TRACE_SCOPE(name)
+#define AOC_TRACE_COUNT(name, n) do {} while (0)
+#define AOC_TRACE_HIST(name, value) do {} while (0)
+#endif
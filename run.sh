@@ -9,6 +9,7 @@ usage() {
     echo "  -h|--help        Print help and exit"
     echo "  -e|--example     Run with the example data"
     echo "  -d|--debug       Run the debug version"
+    echo "  -c|--config CFG  Run the version from output/CFG (release, lto, pgo, ...)"
     echo "  -v|--valgrind    Run the program under valgrind"
     echo "  -t|--time        Run the program with a timer"
     echo ""
@@ -33,6 +34,10 @@ while [[ $# -gt 0 ]]; do
             cfg="debug"
             shift
             ;;
+        -c|--config)
+            cfg="$2"
+            shift 2
+            ;;
         -v|--valgrind)
             vg=1
             shift
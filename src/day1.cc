@@ -1,45 +1,66 @@
+#include <cstdint>
 #include <fstream>
-#include <iostream>
-#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
-std::vector<int> read_input(const std::string& fname) {
+#include "aoc/day.h"
+#include "aoc/generator.h"
+#include "aoc/input.h"
+#include "aoc/parse.h"
+
+#ifdef AOC_EMBED
+#include "aoc/embedded/day1.h"
+#endif
+
+namespace day1 {
+
+// "L68" is -68 and "R48" is 48
+constexpr int parse_turn(std::string_view word) {
+    int direction = 1;
+    if (word.substr(0, 1) == "L") direction = -1;
+    int distance = aoc::parse_int<int>(word.substr(1));
+    return direction * distance;
+}
+
+constexpr std::vector<int> read_input(std::string_view input) {
     std::vector<int> turns;
-    std::ifstream ifile(fname);
-    std::string line;
-    while (ifile >> line)
+    for (std::string_view line : aoc::words(input))
     {
-        int direction = 1;
-        if (line.substr(0, 1) == "L") direction = -1;
-        int distance = std::stoi(line.substr(1));
-        turns.push_back(direction * distance);
+        turns.push_back(parse_turn(line));
     }
-    ifile.close();
     return turns;
 }
 
-int get_code(const std::vector<int>& turns, int start) {
-    int current = start;
+// Counts the turns that leave the dial on zero, one turn at a time
+struct Dial {
+    int current;
     int zeros = 0;
-    for (const int& turn: turns) {
+
+    constexpr void turn(int turn) {
         current += turn;
         while (current < 0) current += 100;
         while (current >= 100) current -= 100;
         if (current == 0) zeros++;
     }
-    return zeros;
+};
+
+constexpr int get_code(const std::vector<int>& turns, int start) {
+    Dial dial = {.current = start};
+    for (const int& turn: turns) {
+        dial.turn(turn);
+    }
+    return dial.zeros;
 }
 
-int get_code_0x434C49434B(const std::vector<int>& turns, int start) {
+// Counts every click that passes zero, one turn at a time
+struct ClickingDial {
     //int prev = start;
-    int current = start;
+    int current;
     int zeros = 0;
     //bool skip_cross_check = false;
-#ifdef DEBUG
-    int line = 0;
-    std::ofstream ofile("day1.log");
-#endif
-    for (const int& turn: turns) {
+
+    void turn(int turn) {
         int full_turns = std::abs(turn / 100);
         int rem_clicks = turn % 100;
         zeros += full_turns;
@@ -62,36 +83,87 @@ int get_code_0x434C49434B(const std::vector<int>& turns, int start) {
         {
             zeros++;
         }
+    }
+};
+
+int get_code_0x434C49434B(const std::vector<int>& turns, int start) {
+    ClickingDial dial = {.current = start};
 #ifdef DEBUG
-        ofile << line << ": " << turn << " => (" << current << "," << zeros << ")" <<std::endl;
+    int line = 0;
+    std::ofstream ofile("day1.log");
+#endif
+    for (const int& turn: turns) {
+        dial.turn(turn);
+#ifdef DEBUG
+        ofile << line << ": " << turn << " => (" << dial.current << "," << dial.zeros << ")" <<std::endl;
         line++;
 #endif
     }
 #ifdef DEBUG
     ofile.close();
 #endif
-    return zeros;
+    return dial.zeros;
 }
 
-int main(int argc, char **argv) {
+// Streaming stage, the turns on each line as they arrive
+aoc::Generator<int> parse_turns(aoc::Generator<std::string_view> lines) {
+    for (std::string_view line : lines) {
+        for (std::string_view word : aoc::words(line)) {
+            co_yield parse_turn(word);
+        }
+    }
+}
+
+struct Solver {
+    using Input = std::vector<int>;
 
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+    // Both dials, saved between runs of the incremental mode
+    static constexpr uint32_t checkpoint_version = 1;
+    struct Checkpoint {
+        Dial dial = {.current = 50};
+        ClickingDial clicking_dial = {.current = 50};
+
+        void fold(std::string_view line) {
+            for (std::string_view word : aoc::words(line)) {
+                int turn = parse_turn(word);
+                dial.turn(turn);
+                clicking_dial.turn(turn);
+            }
+        }
+
+        std::pair<int, int> answers() const {
+            return {dial.zeros, clicking_dial.zeros};
+        }
+    };
+
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return bench.phase("read_input", [&] { return read_input(text); });
+    }
+
+    static int part1(Input& turns, aoc::bench::Harness& bench) {
+        return bench.phase("get_code", [&] { return get_code(turns, 50); });
     }
 
-    // Read the input file
-    std::vector turns = read_input(argv[1]);
+    static int part2(Input& turns, aoc::bench::Harness& bench) {
+        return bench.phase("get_code_0x434C49434B", [&] { return get_code_0x434C49434B(turns, 50); });
+    }
 
-    // Add up the turns
-    int safe_code = get_code(turns, 50);
-    int safe_code_0x434C49434B = get_code_0x434C49434B(turns, 50);
+    // Both dials turn together as the input is read
+    static std::pair<int, int> stream(aoc::Generator<std::string_view> lines) {
+        Dial dial = {.current = 50};
+        ClickingDial clicking_dial = {.current = 50};
+        for (int turn : parse_turns(std::move(lines))) {
+            dial.turn(turn);
+            clicking_dial.turn(turn);
+        }
+        return {dial.zeros, clicking_dial.zeros};
+    }
+};
 
-    // Print results
-    std::cout << "Safe Code: " << safe_code << std::endl;
-    std::cout << "Safe Code 0x434C49434B: " << safe_code_0x434C49434B << std::endl;
+#ifdef AOC_EMBED
+static_assert(!embedded::has_example || get_code(read_input(embedded::example), 50) == 3);
+#endif
 
-    return EXIT_SUCCESS;
+AOC_DAY(1, "Safe Code: ", "Safe Code 0x434C49434B: ");
 
-}
+} // namespace day1
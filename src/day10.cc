@@ -1,34 +1,82 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
-#include <fstream>
-#include <iomanip>
-#include <iostream>
 #include <limits>
 #include <memory>
+#include <memory_resource>
 #include <numeric>
-#include <sstream>
-#include <string>
+#include <span>
+#include <string_view>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "aoc/arena.h"
+#include "aoc/binary.h"
+#include "aoc/day.h"
+#include "aoc/input.h"
+#include "aoc/parallel.h"
+#include "aoc/parse.h"
+#include "aoc/trace.h"
+
+#ifdef DEBUG
+#include <iomanip>
+#include <iostream>
+#endif // DEBUG
+
+namespace day10 {
+
+// One machine, with its buttons and joltages viewed in Machines::values
 struct MachineInfo {
     uint16_t indicator_diagram;
-    std::vector<uint16_t> wiring_schematics;
-    std::vector<uint16_t> joltage_requirements;
+    std::span<const uint16_t> wiring_schematics;
+    std::span<const uint16_t> joltage_requirements;
+};
+
+// Where a machine's buttons, then its joltages, start in the values
+struct MachineRecord {
+    uint32_t first;
+    uint16_t indicator_diagram;
+    uint16_t button_count;
+    uint16_t joltage_count;
+    uint16_t padding;
+};
+
+// Every machine as flat arrays, the same whether parsed or loaded
+struct Machines {
+    aoc::binary::Array<MachineRecord> records;
+    aoc::binary::Array<uint16_t> values;
+
+    size_t size() const { return records.size(); }
+
+    MachineInfo operator[](size_t ii) const {
+        const MachineRecord& record = records[ii];
+        std::span<const uint16_t> machine_values = values.span().subspan(record.first, record.button_count + record.joltage_count);
+        return {
+            .indicator_diagram = record.indicator_diagram,
+            .wiring_schematics = machine_values.first(record.button_count),
+            .joltage_requirements = machine_values.last(record.joltage_count),
+        };
+    }
 };
 
-std::vector<MachineInfo> read_input(const std::string& fname) {
+Machines read_input(std::string_view input) {
     // Read the file
-    std::ifstream ifile(fname);
-    std::string line;
-    std::vector<MachineInfo> machines;
-    while (std::getline(ifile, line)) {
+    std::vector<MachineRecord> records;
+    std::vector<uint16_t> values;
+    std::vector<uint16_t> joltage_requirements;
+    for (std::string_view line : aoc::lines(input)) {
         if (line.empty()) break;
-        std::stringstream ss(line);
-        std::string segment;
-        MachineInfo machine;
-        while(std::getline(ss, segment, ' ')) {
+        MachineRecord machine = {
+            .first = static_cast<uint32_t>(values.size()),
+            .indicator_diagram = 0,
+            .button_count = 0,
+            .joltage_count = 0,
+            .padding = 0,
+        };
+        joltage_requirements.clear();
+        for (std::string_view segment : aoc::fields(line, ' ')) {
+            if (segment.empty()) continue;
             if (segment[0] == '[') {
                 uint16_t indicator_diagram = 0;
                 for (int idx=0; idx<16; idx++) {
@@ -43,27 +91,28 @@ std::vector<MachineInfo> read_input(const std::string& fname) {
                 machine.indicator_diagram = indicator_diagram;
             }
             else if (segment[0] == '(') {
-                std::stringstream ssi(segment.substr(1, segment.length()-2));
-                std::string wire_str;
                 uint16_t wiring_schematic = 0;
-                while (std::getline(ssi, wire_str, ',')) {
-                    uint16_t wire_idx = std::stoul(wire_str);
+                for (std::string_view wire_str : aoc::fields(segment.substr(1, segment.length()-2), ',')) {
+                    uint16_t wire_idx = aoc::parse_int<uint16_t>(wire_str);
                     wiring_schematic |= (1 << wire_idx);
                 }
-                machine.wiring_schematics.push_back(wiring_schematic);
+                values.push_back(wiring_schematic);
+                machine.button_count++;
             }
             else if (segment[0] == '{') {
-                std::stringstream ssi(segment.substr(1, segment.length()-2));
-                std::string joltage_requirement_str;
-                while (std::getline(ssi, joltage_requirement_str, ',')) {
-                    machine.joltage_requirements.push_back(std::stoul(joltage_requirement_str));
+                for (std::string_view joltage_requirement_str : aoc::fields(segment.substr(1, segment.length()-2), ',')) {
+                    joltage_requirements.push_back(aoc::parse_int<uint16_t>(joltage_requirement_str));
                 }
             }
         }
-        machines.push_back(machine);
+        values.insert(values.end(), joltage_requirements.begin(), joltage_requirements.end());
+        machine.joltage_count = static_cast<uint16_t>(joltage_requirements.size());
+        records.push_back(machine);
     }
-    ifile.close();
-    return machines;
+    return {
+        .records = aoc::binary::Array<MachineRecord>(std::move(records)),
+        .values = aoc::binary::Array<uint16_t>(std::move(values)),
+    };
 }
 
 size_t count_min_presses(const MachineInfo& machines) {
@@ -77,12 +126,14 @@ size_t count_min_presses(const MachineInfo& machines) {
     prev_states.insert(0);
     while (true) {
         current_depth++;
+        AOC_TRACE_COUNT("day10/count_min_presses/states_expanded", prev_states.size());
         next_states.clear();
         for (const uint16_t& state : prev_states) {
             for (size_t ii=0; ii<machines.wiring_schematics.size(); ii++) {
                 uint16_t new_state = state ^ machines.wiring_schematics[ii];
                 // Check if we have found the solution
                 if (new_state == machines.indicator_diagram) {
+                    AOC_TRACE_HIST("day10/count_min_presses/depth", current_depth);
                     return current_depth;
                 }
                 next_states.insert(new_state);
@@ -92,16 +143,17 @@ size_t count_min_presses(const MachineInfo& machines) {
     }
 }
 
-size_t count_all_presses(const std::vector<MachineInfo>& machines) {
-    size_t total = 0;
-    for (const MachineInfo& machine : machines) {
-        total += count_min_presses(machine);
-    }
-    return total;
+// The machines are independent, so they are spread over the shared pool
+size_t count_all_presses(const Machines& machines) {
+    return aoc::parallel::parallel_sum<size_t>(machines.size(), 4, [&](size_t ii) {
+        return count_min_presses(machines[ii]);
+    });
 }
 
+using Matrix = std::pmr::vector<std::pmr::vector<int>>;
+
 #ifdef DEBUG
-void disp_matrix(const std::vector<std::vector<int>>& matrix) {
+void disp_matrix(const Matrix& matrix) {
     for (size_t ii=0; ii<matrix.size(); ii++) {
         for (size_t jj=0; jj<matrix[ii].size(); jj++) {
             std::cout << " " << std::setw(4) << matrix[ii][jj];
@@ -112,21 +164,24 @@ void disp_matrix(const std::vector<std::vector<int>>& matrix) {
 }
 #endif
 
-size_t count_joltage_presses(const MachineInfo& machine) {
-    
+// The scratch vectors, including the guess and result on every step of the
+// search, are allocated from memory
+size_t count_joltage_presses(const MachineInfo& machine, std::pmr::memory_resource* memory) {
+    AOC_TRACE_SCOPE("day10/count_joltage_presses");
+
     // create the augmented matrix for the system
     size_t m = machine.joltage_requirements.size();
     size_t n = machine.wiring_schematics.size();
-    std::vector<std::vector<int>> system;
+    Matrix system(memory);
     system.reserve(m);
     for (size_t ii=0; ii<m; ii++) {
-        std::vector<int> row;
+        std::pmr::vector<int> row(memory);
         row.reserve(n + 1);
         for (size_t jj=0; jj<n; jj++) {
             row.push_back((machine.wiring_schematics[jj] & (1 << ii)) >> ii);
         }
         row.push_back(machine.joltage_requirements[ii]);
-        system.push_back(row);
+        system.push_back(std::move(row));
     }
 
 #ifdef DEBUG
@@ -177,7 +232,7 @@ size_t count_joltage_presses(const MachineInfo& machine) {
     }
 
     // Find the pivot rows and do row reduction
-    std::unordered_set<int> pivot_rows;
+    std::pmr::unordered_set<int> pivot_rows(memory);
     for (size_t pivot_search_col=0; pivot_search_col<n; pivot_search_col++) {
         for (size_t row=0; row<m; row++) {
             if (pivot_rows.contains(row)) {
@@ -223,7 +278,7 @@ size_t count_joltage_presses(const MachineInfo& machine) {
         }
         variables[pivot_search_col].var_type = VarType::FREE;
         //}
-next_col:
+next_col:;
     }
 
     // Create an equation for all of the pivot variables
@@ -241,7 +296,7 @@ next_col:
 
     // Attempt to refine the ranges again for positive rows in the new matrix
     for (size_t row=0; row<m; row++) {
-        std::vector<int> update_vars;
+        std::pmr::vector<int> update_vars(memory);
         bool all_positive = true;
         for (size_t col=0; col<n; col++) {
             if (system[row][col] == 0) continue;
@@ -309,7 +364,7 @@ next_col:
     bool iter_done = false;
     int min_presses = std::numeric_limits<int>::max();
 
-#ifdef DEBUG
+#if defined(DEBUG) || defined(AOC_TRACE)
     // Calculate the required number of iterations
     uint64_t dims = 1;
     for (size_t col=0; col<n; col++) {
@@ -317,12 +372,16 @@ next_col:
             dims *= static_cast<uint64_t>(variables[col].range[1] - variables[col].range[0] + 1);
         }
     }
+#endif
+#ifdef DEBUG
     std::cout << "Dimensions: " << dims << std::endl;
 #endif
+    AOC_TRACE_HIST("day10/count_joltage_presses/dimensions", dims);
 
     while (!iter_done) {
-        std::vector<int> guess(n, 0);
-        std::vector<int> result;
+        AOC_TRACE_COUNT("day10/count_joltage_presses/guesses", 1);
+        std::pmr::vector<int> guess(n, 0, memory);
+        std::pmr::vector<int> result(memory);
         bool is_equal = true;
         int sum = 0;
         // Iterate through free variables and assign a value from the range
@@ -421,32 +480,48 @@ update_iter:
     return min_presses;
 }
 
-size_t count_all_joltage_presses(const std::vector<MachineInfo>& machines) {
-    size_t total = 0;
-    for (const MachineInfo& machine : machines) {
-        total += count_joltage_presses(machine);
-    }
-    return total;
+// Arenas are single threaded, so every chunk of machines gets its own
+size_t count_all_joltage_presses(const Machines& machines) {
+    return aoc::parallel::parallel_reduce<size_t>(machines.size(), 4, 0, [&](size_t begin, size_t end) {
+        aoc::Arena arena("day10/count_all_joltage_presses");
+        size_t total = 0;
+        for (size_t ii=begin; ii<end; ii++) {
+            total += count_joltage_presses(machines[ii], arena.resource());
+        }
+        return total;
+    }, [](size_t a, size_t b) { return a + b; });
 }
 
-int main(int argc, char **argv) {
+struct Solver {
+    using Input = Machines;
 
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return bench.phase("read_input", [&] { return read_input(text); });
     }
 
-    // Read the input file
-    std::vector<MachineInfo> machines = read_input(argv[1]);
+    static constexpr uint32_t binary_version = 1;
 
-    // Process the inputs
-    size_t min_presses = count_all_presses(machines);
-    size_t joltage_presses = count_all_joltage_presses(machines);
+    static void compile(const Input& machines, aoc::binary::Writer& out) {
+        out.add(machines.records.span());
+        out.add(machines.values.span());
+    }
 
-    // Output the results
-    std::cout << "Min Button Presses : " << min_presses << std::endl;
-    std::cout << "Min Joltage Presses: " << joltage_presses << std::endl;
+    static Input load(const aoc::binary::Reader& in) {
+        return {
+            .records = aoc::binary::Array<MachineRecord>(in.section<MachineRecord>(0)),
+            .values = aoc::binary::Array<uint16_t>(in.section<uint16_t>(1)),
+        };
+    }
 
-    return EXIT_SUCCESS;
-}
+    static size_t part1(Input& machines, aoc::bench::Harness& bench) {
+        return bench.phase("count_all_presses", [&] { return count_all_presses(machines); });
+    }
+
+    static size_t part2(Input& machines, aoc::bench::Harness& bench) {
+        return bench.phase("count_all_joltage_presses", [&] { return count_all_joltage_presses(machines); });
+    }
+};
+
+AOC_DAY(10, "Min Button Presses : ", "Min Joltage Presses: ");
+
+} // namespace day10
@@ -1,100 +1,190 @@
-#include <fstream>
-#include <iostream>
-#include <sstream>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
-struct Device {
-    std::string name;
-    std::vector<std::string> outputs;
+#include "aoc/arena.h"
+#include "aoc/binary.h"
+#include "aoc/day.h"
+#include "aoc/input.h"
+#include "aoc/trace.h"
+
+namespace day11 {
+
+// Devices are interned as ids 0..n-1 in the order their names first appear,
+// and the graph is kept as flat arrays: the outputs of device id are
+// targets[offsets[id], offsets[id+1]), and its name is
+// names[name_offsets[id], name_offsets[id+1]).
+struct Graph {
+    aoc::binary::Array<uint32_t> offsets;
+    aoc::binary::Array<uint32_t> targets;
+    aoc::binary::Array<uint32_t> name_offsets;
+    aoc::binary::Array<char> names;
+
+    size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+
+    std::span<const uint32_t> outputs(uint32_t id) const {
+        return targets.span().subspan(offsets[id], offsets[id+1] - offsets[id]);
+    }
+
+    std::string_view name(uint32_t id) const {
+        return std::string_view(names.data() + name_offsets[id], name_offsets[id+1] - name_offsets[id]);
+    }
+
+    // Only used for the few named devices, so a scan will do
+    uint32_t find(std::string_view device) const {
+        for (uint32_t id=0; id<size(); id++) {
+            if (name(id) == device) return id;
+        }
+        throw std::out_of_range("no device " + std::string(device));
+    }
 };
 
-std::unordered_map<std::string, Device> read_input(const std::string& fname) {
+Graph read_input(std::string_view input) {
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<std::string_view> device_names;
+    auto intern = [&](std::string_view device) {
+        auto [found, inserted] = ids.try_emplace(device, static_cast<uint32_t>(device_names.size()));
+        if (inserted) device_names.push_back(device);
+        return found->second;
+    };
+
     // Read the file
-    std::ifstream ifile(fname);
-    std::string line;
-    std::unordered_map<std::string, Device> devices;
-    while (std::getline(ifile, line)) {
+    std::vector<std::vector<uint32_t>> adjacency;
+    for (std::string_view line : aoc::lines(input)) {
         if (line.empty()) break;
-        std::string name;
-        std::stringstream ss(line);
-        ss >> name;
-        name = name.substr(0, name.size()-1);
-        Device& device = devices[name];
-        device.name = name;
-        std::string output;
-        while (ss >> output) {
-            device.outputs.push_back(output);
+        aoc::Words words = aoc::words(line);
+        std::string_view name;
+        words.next(name);
+        uint32_t id = intern(name.substr(0, name.size()-1));
+        std::vector<uint32_t> outputs;
+        std::string_view output;
+        while (words.next(output)) {
+            outputs.push_back(intern(output));
         }
+        if (adjacency.size() <= id) adjacency.resize(id + 1);
+        adjacency[id] = std::move(outputs);
+    }
+    adjacency.resize(device_names.size());
+
+    // Flatten it
+    std::vector<uint32_t> offsets = {0};
+    std::vector<uint32_t> targets;
+    std::vector<uint32_t> name_offsets = {0};
+    std::vector<char> names;
+    for (size_t id=0; id<device_names.size(); id++) {
+        targets.insert(targets.end(), adjacency[id].begin(), adjacency[id].end());
+        offsets.push_back(static_cast<uint32_t>(targets.size()));
+        names.insert(names.end(), device_names[id].begin(), device_names[id].end());
+        name_offsets.push_back(static_cast<uint32_t>(names.size()));
     }
-    ifile.close();
-    return devices;
+    return {
+        .offsets = aoc::binary::Array<uint32_t>(std::move(offsets)),
+        .targets = aoc::binary::Array<uint32_t>(std::move(targets)),
+        .name_offsets = aoc::binary::Array<uint32_t>(std::move(name_offsets)),
+        .names = aoc::binary::Array<char>(std::move(names)),
+    };
 }
 
+// The devices a path still has to pass through are a bit mask over
+// pass_thru, so the cache is a flat table of device by mask that lives in
+// the arena of the top level call
+constexpr size_t NOT_CACHED = std::numeric_limits<size_t>::max();
+using PathCache = std::pmr::vector<size_t>;
+
 size_t count_paths(
-    const std::unordered_map<std::string, Device>& devices,
-    const std::string& start = "you",
-    const std::string& end = "out",
-    const std::unordered_set<std::string>& pass_thru = {},
-    std::unordered_map<std::string, size_t>* cache = nullptr
+    const Graph& graph,
+    uint32_t start,
+    uint32_t end,
+    std::span<const uint32_t> pass_thru,
+    uint32_t remaining,
+    PathCache& cache
 ) {
-    std::stringstream cache_key;
-    cache_key << start;
-    for (const std::string& pt : pass_thru) {
-        cache_key << pt;
+    // The table is sized up front, so the reference stays valid
+    size_t& cached = cache[(static_cast<size_t>(remaining) * graph.size()) + start];
+    if (cached != NOT_CACHED) {
+        AOC_TRACE_COUNT("day11/count_paths/cache_hits", 1);
+        return cached;
     }
-    bool do_free = false;
-    if (cache == nullptr) {
-        do_free = true;
-        cache = new std::unordered_map<std::string, size_t>;
-    }
-    if (cache->contains(cache_key.str())) {
-        return cache->at(cache_key.str());
+    AOC_TRACE_COUNT("day11/count_paths/cache_misses", 1);
+    // Leaving start passes through it
+    uint32_t remaining_update = remaining;
+    for (size_t ii=0; ii<pass_thru.size(); ii++) {
+        if (pass_thru[ii] == start) remaining_update &= ~(1u << ii);
     }
     size_t path_count = 0;
-    const Device& device = devices.at(start);
-    for (const std::string& output : device.outputs) {
-        if (output == end && pass_thru.empty()) {
+    for (uint32_t output : graph.outputs(start)) {
+        if (output == end && remaining == 0) {
             path_count++;
         }
         else if (output == end) {
             continue;
         }
         else {
-            std::unordered_set<std::string> pass_thru_update = pass_thru;
-            pass_thru_update.erase(start);
-            path_count += count_paths(devices, output, end, pass_thru_update, cache);
+            path_count += count_paths(graph, output, end, pass_thru, remaining_update, cache);
         }
     }
-    if (do_free) {
-        delete cache;
-    }
-    else {
-        cache->insert(std::make_pair(cache_key.str(), path_count));
-    }
+    cached = path_count;
     return path_count;
 }
 
-int main(int argc, char **argv) {
+size_t count_paths(
+    const Graph& graph,
+    std::string_view start = "you",
+    std::string_view end = "out",
+    std::initializer_list<std::string_view> pass_thru = {}
+) {
+    std::vector<uint32_t> pass_thru_ids;
+    for (std::string_view device : pass_thru) {
+        pass_thru_ids.push_back(graph.find(device));
+    }
+    aoc::Arena arena("day11/count_paths");
+    PathCache cache(graph.size() << pass_thru_ids.size(), NOT_CACHED, arena.resource());
+    uint32_t remaining = (1u << pass_thru_ids.size()) - 1;
+    return count_paths(graph, graph.find(start), graph.find(end), pass_thru_ids, remaining, cache);
+}
+
+struct Solver {
+    using Input = Graph;
 
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return bench.phase("read_input", [&] { return read_input(text); });
     }
 
-    // Read the input file
-    std::unordered_map<std::string, Device> devices = read_input(argv[1]);
+    static constexpr uint32_t binary_version = 1;
 
-    // Process the inputs
-    size_t num_paths = count_paths(devices, "you");
-    size_t svr_paths = count_paths(devices, "svr", "out", {"dac", "fft"});
+    static void compile(const Input& graph, aoc::binary::Writer& out) {
+        out.add(graph.offsets.span());
+        out.add(graph.targets.span());
+        out.add(graph.name_offsets.span());
+        out.add(graph.names.span());
+    }
 
-    // Output the results
-    std::cout << "All paths: " << num_paths << std::endl;
-    std::cout << "Server paths: " << svr_paths << std::endl;
+    static Input load(const aoc::binary::Reader& in) {
+        return {
+            .offsets = aoc::binary::Array<uint32_t>(in.section<uint32_t>(0)),
+            .targets = aoc::binary::Array<uint32_t>(in.section<uint32_t>(1)),
+            .name_offsets = aoc::binary::Array<uint32_t>(in.section<uint32_t>(2)),
+            .names = aoc::binary::Array<char>(in.section<char>(3)),
+        };
+    }
 
-    return EXIT_SUCCESS;
-}
+    static size_t part1(Input& graph, aoc::bench::Harness& bench) {
+        return bench.phase("count_paths (you)", [&] { return count_paths(graph, "you"); });
+    }
+
+    static size_t part2(Input& graph, aoc::bench::Harness& bench) {
+        return bench.phase("count_paths (svr)", [&] { return count_paths(graph, "svr", "out", {"dac", "fft"}); });
+    }
+};
+
+AOC_DAY(11, "All paths: ", "Server paths: ");
+
+} // namespace day11
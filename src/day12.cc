@@ -1,9 +1,14 @@
 #include <array>
-#include <fstream>
-#include <iostream>
-#include <string>
+#include <string_view>
 #include <vector>
 
+#include "aoc/day.h"
+#include "aoc/input.h"
+#include "aoc/parallel.h"
+#include "aoc/parse.h"
+
+namespace day12 {
+
 const size_t NUM_SHAPES = 6;
 
 struct Present {
@@ -22,17 +27,17 @@ struct Input {
     std::vector<Region> regions;
 };
 
-Input read_input(const std::string& fname) {
+Input read_input(std::string_view text) {
     // Read the file
-    std::ifstream ifile(fname);
-    std::string line;
+    aoc::Splitter lines = aoc::lines(text);
+    std::string_view line;
     Input input;
     for (size_t present_idx=0; present_idx<NUM_SHAPES; present_idx++) {
-        std::getline(ifile, line);
+        lines.next(line);
         Present present;
         present.area = 0;
         for (size_t row=0; row<3; row++) {
-            std::getline(ifile, line);
+            lines.next(line);
             for (size_t col=0; col<3; col++) {
                 if (line[col] == '#') {
                     present.area++;
@@ -41,68 +46,65 @@ Input read_input(const std::string& fname) {
             }
         }
         input.presents[present_idx] = present;
-        std::getline(ifile, line);
+        lines.next(line);
     }
 
-    std::vector<Region> regions;
-    while (std::getline(ifile, line)) {
-        Region region;
-        sscanf(
-            line.c_str(), "%dx%d: %d %d %d %d %d",
-            &region.width,
-            &region.height,
-            &region.presents[0],
-            &region.presents[1],
-            &region.presents[2],
-            &region.presents[3],
-            &region.presents[4]
-        );
+    while (lines.next(line)) {
+        if (line.empty()) break;
+        // Lines look like "WxH: n0 n1 n2 n3 n4 n5". Only the first five
+        // counts are read, matching the old "%dx%d: %d %d %d %d %d" format.
+        Region region = {};
+        auto [dims, str_counts] = aoc::split_pair(line, ':');
+        auto [str_width, str_height] = aoc::split_pair(dims, 'x');
+        region.width = aoc::parse_int<int>(str_width);
+        region.height = aoc::parse_int<int>(str_height);
+        aoc::Words counts = aoc::words(str_counts);
+        std::string_view count;
+        for (size_t pidx=0; pidx<NUM_SHAPES-1 && counts.next(count); pidx++) {
+            region.presents[pidx] = aoc::parse_int<int>(count);
+        }
         input.regions.push_back(region);
     }
-    ifile.close();
     return input;
 }
 
-int presents_fit_in_region(const Input& input) {
-    int num_fit = 0;
-    for (const Region& region : input.regions) {
-        int region_area = region.width * region.height;
-        int present_area = 0;
-        int total_presents = 0;
-        for (size_t pidx=0; pidx<input.presents.size(); pidx++) {
-            present_area += region.presents[pidx] * input.presents[pidx].area;
-            total_presents += region.presents[pidx];
-        }
-        //std::cout << "Presents: " << present_area << " Region: " << region_area << std::endl;
-        if (present_area > region_area) {
-            continue;
-        }
-        int min_presents = (region.width / 3) * (region.height / 3);
-        //std::cout << "Min Fit: " << min_presents << " Num: " << total_presents << std::endl;
-        if (total_presents <= min_presents) {
-            num_fit++;
-            continue;
-        }
+bool present_fits(const Input& input, const Region& region) {
+    int region_area = region.width * region.height;
+    int present_area = 0;
+    int total_presents = 0;
+    for (size_t pidx=0; pidx<input.presents.size(); pidx++) {
+        present_area += region.presents[pidx] * input.presents[pidx].area;
+        total_presents += region.presents[pidx];
     }
-    return num_fit;
+    //std::cout << "Presents: " << present_area << " Region: " << region_area << std::endl;
+    if (present_area > region_area) {
+        return false;
+    }
+    int min_presents = (region.width / 3) * (region.height / 3);
+    //std::cout << "Min Fit: " << min_presents << " Num: " << total_presents << std::endl;
+    return total_presents <= min_presents;
 }
 
-int main(int argc, char **argv) {
+// The regions are independent, so chunks of them are spread over the shared pool
+int presents_fit_in_region(const Input& input) {
+    return aoc::parallel::parallel_sum<int>(input.regions.size(), 256, [&](size_t ii) {
+        return present_fits(input, input.regions[ii]) ? 1 : 0;
+    });
+}
 
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
-    }
+// There is no second part to solve on the last day
+struct Solver {
+    using Input = day12::Input;
 
-    // Read the input file
-    Input input = read_input(argv[1]);
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return bench.phase("read_input", [&] { return read_input(text); });
+    }
 
-    // Process the inputs
-    int presents_fit = presents_fit_in_region(input);
+    static int part1(Input& input, aoc::bench::Harness& bench) {
+        return bench.phase("presents_fit_in_region", [&] { return presents_fit_in_region(input); });
+    }
+};
 
-    // Output the results
-    std::cout << "Presents that fit: " << presents_fit << std::endl;
+AOC_DAY(12, "Presents that fit: ", nullptr);
 
-    return EXIT_SUCCESS;
-}
+} // namespace day12
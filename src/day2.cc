@@ -1,108 +1,131 @@
 #include <array>
 #include <cmath>
-#include <fstream>
-#include <iostream>
+#include <limits>
 #include <set>
 #include <string>
-#include <sstream>
+#include <string_view>
 #include <vector>
 
-std::vector<std::array<std::string, 2>> read_input(const std::string& fname) {
-    std::ifstream ifile(fname);
-    std::string str_range;
-    std::vector<std::array<std::string, 2>> ranges;
-    while(std::getline(ifile, str_range, ',')) {
-        size_t dash_idx = str_range.find('-');
-        std::string s1 = str_range.substr(0,dash_idx);
-        std::string s2 = str_range.substr(dash_idx+1);
-        if (s2.back() == '\n') {
-            s2.pop_back();
+#include "aoc/day.h"
+#include "aoc/input.h"
+#include "aoc/parallel.h"
+#include "aoc/parse.h"
+
+#ifdef DEBUG
+#include <iostream>
+#endif // DEBUG
+
+namespace day2 {
+
+using Range = std::array<std::string_view, 2>;
+
+std::vector<Range> read_input(std::string_view input) {
+    return aoc::parallel::parallel_parse<Range>(input, ',', [](std::string_view piece, std::vector<Range>& ranges) {
+        for (std::string_view str_range : aoc::fields(piece, ',')) {
+            auto [s1, s2] = aoc::split_pair(str_range, '-');
+            if (s2.back() == '\n') {
+                s2.remove_suffix(1);
+            }
+            ranges.push_back({s1, s2});
         }
-        std::array<std::string, 2> range = {s1, s2};
-        ranges.push_back(range);
+        return true;
+    });
+}
+
+// value with the decimal digits of ii written after it, e.g. 12 and 34 give
+// 1234, or the largest value when that does not fit, which is past any range
+constexpr u_int64_t append_digits(u_int64_t value, u_int64_t ii) {
+    u_int64_t shift = 10;
+    while (shift <= ii) {
+        shift *= 10;
     }
-    ifile.close();
-    return ranges;
+    u_int64_t result = 0;
+    if (__builtin_mul_overflow(value, shift, &result) || __builtin_add_overflow(result, ii, &result)) {
+        return std::numeric_limits<u_int64_t>::max();
+    }
+    return result;
 }
 
-u_int64_t sum_invalid_ids(const std::vector<std::array<std::string, 2>>& ranges) {
-    u_int64_t grand_sum = 0;
-    for (const std::array<std::string, 2>& range: ranges) {
-        // Find the minimum possible value
-        size_t lb_len = range[0].length();
-        u_int64_t min = 1;
-        // Odd number of digits
-        if (lb_len & 0x01)
+// Sum of the invalid IDs in one range
+u_int64_t sum_invalid_ids(const Range& range) {
+    // Find the minimum possible value
+    size_t lb_len = range[0].length();
+    u_int64_t min = 1;
+    // Odd number of digits
+    if (lb_len & 0x01)
+    {
+        lb_len = (lb_len + 1) >> 1;
+        for (size_t ii=1; ii<lb_len; ii++)
         {
-            lb_len = (lb_len + 1) >> 1;
-            for (size_t ii=1; ii<lb_len; ii++)
-            {
-                min *= 10;
-            }
+            min *= 10;
         }
-        // Even number of digits
-        else
-        {
-            u_int64_t mid = lb_len >> 1;
-            min = std::stoull(range[0].substr(0, mid));
-            u_int64_t v2 = std::stoull(range[0].substr(mid));
-            if (v2 > min) {
-                min++;
-            }
+    }
+    // Even number of digits
+    else
+    {
+        u_int64_t mid = lb_len >> 1;
+        min = aoc::parse_int<u_int64_t>(range[0].substr(0, mid));
+        u_int64_t v2 = aoc::parse_int<u_int64_t>(range[0].substr(mid));
+        if (v2 > min) {
+            min++;
         }
+    }
 
-        // Find the maximum possible value
-        size_t ub_len = range[1].length();
-        if (ub_len < 2)
+    // Find the maximum possible value
+    size_t ub_len = range[1].length();
+    if (ub_len < 2)
+    {
+        return 0;
+    }
+    u_int64_t max = 10;
+    // Odd number of digits
+    if (ub_len & 0x01)
+    {
+        ub_len = (ub_len - 1) >> 1;
+        for (size_t ii=1; ii<ub_len; ii++)
         {
-            continue;
+            max *= 10;
         }
-        u_int64_t max = 10;
-        // Odd number of digits
-        if (ub_len & 0x01)
-        {
-            ub_len = (ub_len - 1) >> 1;
-            for (size_t ii=1; ii<ub_len; ii++)
-            {
-                max *= 10;
-            }
-            max -= 1;
-        }
-        // Even number of digits
-        else
-        {
-            u_int64_t mid = ub_len >> 1;
-            max = std::stoull(range[1].substr(0, mid));
-            u_int64_t v2 = std::stoull(range[1].substr(mid));
-            if (v2 < max) {
-                max--;
-            }
+        max -= 1;
+    }
+    // Even number of digits
+    else
+    {
+        u_int64_t mid = ub_len >> 1;
+        max = aoc::parse_int<u_int64_t>(range[1].substr(0, mid));
+        u_int64_t v2 = aoc::parse_int<u_int64_t>(range[1].substr(mid));
+        if (v2 < max) {
+            max--;
         }
+    }
 
-        // Nothing to search
-        if (min > max) {
-            continue;
-        }
+    // Nothing to search
+    if (min > max) {
+        return 0;
+    }
 
-        // Sum up the values
-        u_int64_t sum = 0;
-        for (u_int64_t ii=min; ii<=max; ii++) {
-            std::stringstream ss("");
-            ss << ii << ii;
-            sum += std::stoull(ss.str());
-        }
-        grand_sum += sum;
+    // Sum up the values
+    u_int64_t sum = 0;
+    for (u_int64_t ii=min; ii<=max; ii++) {
+        sum += append_digits(ii, ii);
     }
-    return grand_sum;
+    return sum;
 }
 
-u_int64_t sum_invalid_ids_2(const std::vector<std::array<std::string, 2>>& ranges) {
+// Every range is independent, so they are spread over the shared pool
+u_int64_t sum_invalid_ids(const std::vector<Range>& ranges) {
+    return aoc::parallel::parallel_sum<u_int64_t>(ranges.size(), 1, [&](size_t ii) {
+        return sum_invalid_ids(ranges[ii]);
+    });
+}
+
+u_int64_t sum_invalid_ids_2(const std::vector<Range>& ranges) {
     u_int64_t grand_sum = 0;
-    for (const std::array<std::string, 2>& range: ranges) {
+    for (const Range& range: ranges) {
 
         // Get the full min and max values of the range
-        u_int64_t full_min = std::stoull(range[0]);
-        u_int64_t full_max = std::stoull(range[1]);
+        u_int64_t full_min = aoc::parse_int<u_int64_t>(range[0]);
+        u_int64_t full_max = aoc::parse_int<u_int64_t>(range[1]);
 
 #ifdef DEBUG
         std::cout << full_min << "-" << full_max << std::endl;
@@ -129,8 +152,8 @@ u_int64_t sum_invalid_ids_2(const std::vector<std::array<std::string, 2>>& range
         else
         {
             u_int64_t mid = ub_len >> 1;
-            max = std::stoull(range[1].substr(0, mid));
-            u_int64_t v2 = std::stoull(range[1].substr(mid));
+            max = aoc::parse_int<u_int64_t>(range[1].substr(0, mid));
+            u_int64_t v2 = aoc::parse_int<u_int64_t>(range[1].substr(mid));
             if (v2 < max) {
                 max--;
             }
@@ -141,10 +164,9 @@ u_int64_t sum_invalid_ids_2(const std::vector<std::array<std::string, 2>>& range
         std::set<u_int64_t> used_values;
         used_values.clear();
         for (u_int64_t ii=1; ii<=max; ii++) {
-            std::stringstream ss("");
+            u_int64_t test_val = 0;
             while (true) {
-                ss << ii;
-                u_int64_t test_val = std::stoull(ss.str());
+                test_val = append_digits(test_val, ii);
                 if (test_val >= full_min && test_val <= full_max) {
                     if (!used_values.contains(test_val)) {
                         sum += test_val;
@@ -164,21 +186,22 @@ u_int64_t sum_invalid_ids_2(const std::vector<std::array<std::string, 2>>& range
     return grand_sum;
 }
 
-int main(int argc, char **argv) {
-    
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+struct Solver {
+    using Input = std::vector<Range>;
+
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return bench.phase("read_input", [&] { return read_input(text); });
     }
 
-    // Read the input file
-    std::vector<std::array<std::string, 2>> ranges = read_input(argv[1]);
+    static u_int64_t part1(Input& ranges, aoc::bench::Harness& bench) {
+        return bench.phase("sum_invalid_ids", [&] { return sum_invalid_ids(ranges); });
+    }
 
-    u_int64_t sum = sum_invalid_ids(ranges);
-    u_int64_t sum2 = sum_invalid_ids_2(ranges);
-    std::cout << "Sum: " << sum << std::endl;
-    std::cout << "Sum 2: " << sum2 << std::endl;
+    static u_int64_t part2(Input& ranges, aoc::bench::Harness& bench) {
+        return bench.phase("sum_invalid_ids_2", [&] { return sum_invalid_ids_2(ranges); });
+    }
+};
 
-    return EXIT_SUCCESS;
-}
+AOC_DAY(2, "Sum: ", "Sum 2: ");
+
+} // namespace day2
@@ -1,93 +1,208 @@
-#include <array>
-#include <fstream>
-#include <iostream>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-std::vector<std::vector<size_t>> read_input(const std::string& fname) {
-    std::string line;
-    std::ifstream ifile(fname);
-    std::vector<std::vector<size_t>> grid;
-    while (std::getline(ifile, line)) {
+#include "aoc/arena.h"
+#include "aoc/day.h"
+#include "aoc/generator.h"
+#include "aoc/input.h"
+#include "aoc/parallel.h"
+#include "aoc/simd.h"
+
+#ifdef AOC_EMBED
+#include "aoc/embedded/day3.h"
+#endif
+
+namespace day3 {
+
+// Every bank is allocated from the arena the caller passes in
+using Bank = std::pmr::vector<uint8_t>;
+using BatteryBanks = std::pmr::vector<Bank>;
+
+// Appends a bank per line. Pmr banks get their allocator from grid, and plain
+// vectors of vectors work in constant expressions.
+template <typename Banks>
+constexpr void read_banks(std::string_view input, Banks& grid) {
+    for (std::string_view line : aoc::lines(input)) {
         if (line.empty()) break;
-        std::vector<size_t> row;
+        auto& row = grid.emplace_back();
+        row.reserve(line.size());
         for (const char& c: line) {
-            row.push_back(static_cast<size_t> (c - '0'));
+            row.push_back(static_cast<uint8_t> (c - '0'));
         }
-        grid.push_back(row);
     }
-    ifile.close();
-    return grid;
 }
 
-size_t sum_largest_two_digits(const std::vector<std::vector<size_t>>& battery_banks) {
-    size_t sum = 0;
-    for (const std::vector<size_t>& bank : battery_banks) {
-        // Find the first digit
-        size_t first_value = 0;
-        size_t first_index = 0;
-        for (size_t ii=0; ii<(bank.size()-1); ii++) {
-            if (bank[ii] > first_value) {
-                first_value = bank[ii];
-                first_index = ii;
+BatteryBanks read_input(std::string_view input, std::pmr::memory_resource* memory) {
+    // Find the lines in pieces on the pool, then reserve every bank here, as
+    // the arena is not thread safe, and fill them in on the pool, which stays
+    // within the reserved capacity and never allocates
+    std::vector<std::string_view> lines = aoc::parallel::parallel_parse<std::string_view>(input, '\n',
+        [](std::string_view piece, std::vector<std::string_view>& found) {
+            for (std::string_view line : aoc::lines(piece)) {
+                if (line.empty()) return false;
+                found.push_back(line);
+            }
+            return true;
+        });
+    BatteryBanks grid(memory);
+    grid.reserve(lines.size());
+    for (std::string_view line : lines) {
+        grid.emplace_back().reserve(line.size());
+    }
+    aoc::parallel::parallel_for(lines.size(), 2048, [&](size_t begin, size_t end) {
+        for (size_t ii=begin; ii<end; ii++) {
+            for (const char& c : lines[ii]) {
+                grid[ii].push_back(static_cast<uint8_t>(c - '0'));
             }
-            if (first_value == 9) break;
         }
-        // Find the second digit
-        size_t second_value = 0;
-        for (size_t ii=(first_index+1); ii<bank.size(); ii++) {
-            if (bank[ii] > second_value) {
-                second_value = bank[ii];
+    });
+    return grid;
+}
+
+// Index of the first largest digit in bank[begin, end). Byte digits look for
+// a 9 with memchr, which most ranges have early on, and otherwise go through
+// the SIMD kernel. Anything else and constant evaluation scan here.
+template <typename Digits>
+constexpr size_t first_largest(const Digits& bank, size_t begin, size_t end) {
+    if constexpr (std::is_same_v<typename Digits::value_type, uint8_t>) {
+        if (!std::is_constant_evaluated()) {
+            const uint8_t* digits = bank.data();
+            if (const void* nine = std::memchr(digits + begin, 9, end - begin)) {
+                return static_cast<size_t>(static_cast<const uint8_t*>(nine) - digits);
             }
-            if (second_value == 9) break;
+            return begin + aoc::simd::first_max(digits + begin, end - begin);
         }
-        sum += (first_value * 10) + second_value;
     }
-    return sum;
+    size_t index = begin;
+    for (size_t ii=begin; ii<end; ii++) {
+        if (bank[ii] > bank[index]) index = ii;
+        if (bank[index] == 9) break;
+    }
+    return index;
 }
 
-size_t sum_largest_12_digits(const std::vector<std::vector<size_t>>& battery_banks) {
+template <typename Digits>
+constexpr size_t largest_two_digits(const Digits& bank) {
+    size_t first_index = first_largest(bank, 0, bank.size()-1);
+    size_t second_index = first_largest(bank, first_index+1, bank.size());
+    return (static_cast<size_t>(bank[first_index]) * 10) + bank[second_index];
+}
+
+template <typename Banks>
+constexpr size_t sum_largest_two_digits(const Banks& battery_banks) {
     size_t sum = 0;
-    for (const std::vector<size_t>& bank : battery_banks) {
-        std::array<size_t, 12> values = {0};
-        std::array<size_t, 12> indices = {0};
-        for (size_t digit=0; digit<12; digit++) {
-            for (size_t ii=indices[digit]; ii<(bank.size()-11+digit); ii++) {
-                if (bank[ii] > values[digit]) {
-                    values[digit] = bank[ii];
-                    if (digit < (12-1)) {
-                        indices[digit+1] = ii+1;
-                    }
-                }
-                if (values[digit] == 9) break;
+    for (const auto& bank : battery_banks) {
+        sum += largest_two_digits(bank);
+    }
+    return sum;
+}
+
+// Each digit is the first largest one that still leaves enough after it
+template <typename Digits>
+size_t largest_12_digits(const Digits& bank) {
+    size_t joltage = 0;
+    size_t begin = 0;
+    for (size_t digit=0; digit<12; digit++) {
+        size_t index = first_largest(bank, begin, bank.size()-11+digit);
+        joltage = (joltage * 10) + bank[index];
+        begin = index + 1;
+    }
+    return joltage;
+}
+
+// The banks are independent, so chunks of them are spread over the shared pool
+size_t sum_largest_12_digits(const BatteryBanks& battery_banks) {
+    return aoc::parallel::parallel_sum<size_t>(battery_banks.size(), 32, [&](size_t ii) {
+        return largest_12_digits(battery_banks[ii]);
+    });
+}
+
+// Streaming stage, each bank's digits in one buffer that is reused for the next
+aoc::Generator<std::vector<uint8_t>> parse_banks(aoc::Generator<std::string_view> lines) {
+    std::vector<uint8_t> bank;
+    for (std::string_view line : lines) {
+        if (line.empty()) break;
+        bank.clear();
+        for (const char& c: line) {
+            bank.push_back(static_cast<uint8_t> (c - '0'));
+        }
+        co_yield bank;
+    }
+}
+
+struct Solver {
+    // The running sums, saved between runs of the incremental mode. A blank
+    // line ends the banks.
+    static constexpr uint32_t checkpoint_version = 1;
+    struct Checkpoint {
+        size_t joltage = 0;
+        size_t big_joltage = 0;
+        bool done = false;
+
+        void fold(std::string_view line) {
+            if (done || line.empty()) {
+                done = true;
+                return;
+            }
+            std::vector<uint8_t> bank(line.size());
+            for (size_t ii=0; ii<line.size(); ii++) {
+                bank[ii] = static_cast<uint8_t>(line[ii] - '0');
             }
+            joltage += largest_two_digits(bank);
+            big_joltage += largest_12_digits(bank);
         }
-        size_t scale = 1;
-        for (int ii=11; ii>=0; ii--) {
-            sum += scale * values[ii];
-            scale *= 10;
+
+        std::pair<size_t, size_t> answers() const {
+            return {joltage, big_joltage};
         }
+    };
+
+    // The banks are allocated from the arena, which has to outlive them
+    struct Input {
+        std::unique_ptr<aoc::Arena> arena;
+        BatteryBanks battery_banks;
+    };
+
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        std::unique_ptr<aoc::Arena> arena = std::make_unique<aoc::Arena>("day3/read_input");
+        BatteryBanks battery_banks = bench.phase("read_input", [&] { return read_input(text, arena->resource()); });
+        return {std::move(arena), std::move(battery_banks)};
     }
-    return sum;
-}
 
-int main(int argc, char **argv) {
-    
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+    static size_t part1(Input& input, aoc::bench::Harness& bench) {
+        return bench.phase("sum_largest_two_digits", [&] { return sum_largest_two_digits(input.battery_banks); });
     }
 
-    // Read the input file
-    std::vector<std::vector<size_t>> battery_banks = read_input(argv[1]);
+    static size_t part2(Input& input, aoc::bench::Harness& bench) {
+        return bench.phase("sum_largest_12_digits", [&] { return sum_largest_12_digits(input.battery_banks); });
+    }
 
-    // Process the inputs
-    size_t joltage1 = sum_largest_two_digits(battery_banks);
-    size_t joltage2 = sum_largest_12_digits(battery_banks);
+    // Both parts only look at one bank at a time
+    static std::pair<size_t, size_t> stream(aoc::Generator<std::string_view> lines) {
+        size_t joltage = 0;
+        size_t big_joltage = 0;
+        for (const std::vector<uint8_t>& bank : parse_banks(std::move(lines))) {
+            joltage += largest_two_digits(bank);
+            big_joltage += largest_12_digits(bank);
+        }
+        return {joltage, big_joltage};
+    }
+};
 
-    // Output the results
-    std::cout << "Joltage: " << joltage1 << std::endl;
-    std::cout << "Big Joltage: " << joltage2 << std::endl;
+#ifdef AOC_EMBED
+static_assert(!embedded::has_example || [] {
+    std::vector<std::vector<uint8_t>> battery_banks;
+    read_banks(embedded::example, battery_banks);
+    return sum_largest_two_digits(battery_banks);
+}() == 357);
+#endif
 
-    return EXIT_SUCCESS;
-}
+AOC_DAY(3, "Joltage: ", "Big Joltage: ");
+
+} // namespace day3
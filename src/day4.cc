@@ -1,93 +1,59 @@
-#include <fstream>
-#include <iostream>
-#include <string>
-#include <vector>
+#include <cstddef>
+#include <string_view>
 
-std::vector<std::string> read_input(const std::string& fname) {
-    std::string line;
-    std::ifstream ifile(fname);
-    std::vector<std::string> map;
-    while (std::getline(ifile, line)) {
-        if (line.empty()) break;
-        map.push_back(line);
-    }
-    ifile.close();
-    return map;
+#include "aoc/day.h"
+#include "aoc/grid.h"
+#include "aoc/input.h"
+#include "aoc/simd.h"
+
+namespace day4 {
+
+// The map with a border of empty floor, so every cell has eight neighbours
+aoc::Grid<char> read_input(std::string_view input) {
+    return aoc::read_grid(input, 1, '.');
 }
 
-int count_accessible(const std::vector<std::string>& map) {
-    int accessible = 0;
-    for (int yy=0; yy<map.size(); yy++) {
-        for (int xx=0; xx<map[yy].length(); xx++) {
-            char value = map[yy][xx];
-            if (value != '@') continue;
-            int nearby_count = 0;
-            for (int y_offset=-1; y_offset<=1; y_offset++) {
-                for (int x_offset=-1; x_offset<=1; x_offset++) {
-                    int y_test = yy + y_offset;
-                    if (y_test < 0 || y_test >= map.size()) continue;
-                    int x_test = xx + x_offset;
-                    if (x_test < 0 || x_test >= map[xx].length()) continue;
-                    if (y_test == yy && x_test == xx) continue;
-                    if (map[y_test][x_test] == '@') nearby_count++;
-                }
-            }
-            if (nearby_count < 4) accessible++;
-        }
+// Rows are checked a vector of cells at a time, see aoc/simd.h
+int count_accessible(const aoc::Grid<char>& map) {
+    size_t accessible = 0;
+    for (ptrdiff_t yy=0; yy<static_cast<ptrdiff_t>(map.height()); yy++) {
+        accessible += aoc::simd::count_accessible(map.row(yy-1), map.row(yy), map.row(yy+1), map.width());
     }
-    return accessible;
+    return static_cast<int>(accessible);
 }
 
-int count_all(const std::vector<std::string>& map) {
-    std::vector<std::string> copy = map;
-    int accessible = 0;
-    int new_removals = 1;
+// Removing a roll only ever makes its neighbours easier to remove, so the
+// order the rows and cells are removed in doesn't change the total
+int count_all(const aoc::Grid<char>& map) {
+    aoc::Grid<char> copy = map;
+    size_t accessible = 0;
+    size_t new_removals = 1;
     while(new_removals) {
         new_removals = 0;
-        for (int yy=0; yy<copy.size(); yy++) {
-            for (int xx=0; xx<copy[yy].length(); xx++) {
-                char value = copy[yy][xx];
-                if (value != '@') continue;
-                int nearby_count = 0;
-                for (int y_offset=-1; y_offset<=1; y_offset++) {
-                    for (int x_offset=-1; x_offset<=1; x_offset++) {
-                        int y_test = yy + y_offset;
-                        if (y_test < 0 || y_test >= copy.size()) continue;
-                        int x_test = xx + x_offset;
-                        if (x_test < 0 || x_test >= copy[xx].length()) continue;
-                        if (y_test == yy && x_test == xx) continue;
-                        if (copy[y_test][x_test] == '@') nearby_count++;
-                    }
-                }
-                if (nearby_count < 4) {
-                    copy[yy][xx] = 'x';
-                    new_removals++;
-                    accessible++;
-                }
-            }
+        for (ptrdiff_t yy=0; yy<static_cast<ptrdiff_t>(copy.height()); yy++) {
+            new_removals += aoc::simd::remove_accessible(copy.row(yy-1), copy.row(yy), copy.row(yy+1), copy.width());
         }
+        accessible += new_removals;
     }
-    return accessible;
+    return static_cast<int>(accessible);
 }
 
-int main(int argc, char **argv) {
-    
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+struct Solver {
+    using Input = aoc::Grid<char>;
+
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return bench.phase("read_input", [&] { return read_input(text); });
     }
 
-    // Read the input file
-    std::vector<std::string> map = read_input(argv[1]);
+    static int part1(Input& map, aoc::bench::Harness& bench) {
+        return bench.phase("count_accessible", [&] { return count_accessible(map); });
+    }
 
-    // Process the inputs
-    int accessible = count_accessible(map);
-    int remove_all = count_all(map);
+    static int part2(Input& map, aoc::bench::Harness& bench) {
+        return bench.phase("count_all", [&] { return count_all(map); });
+    }
+};
 
-    // Output the results
-    std::cout << "# Accessible: " << accessible << std::endl;
-    std::cout << "# Removed: " << remove_all << std::endl;
+AOC_DAY(4, "# Accessible: ", "# Removed: ");
 
-    return EXIT_SUCCESS;
-}
+} // namespace day4
@@ -1,23 +1,29 @@
 #include <algorithm>
 #include <array>
-#include <fstream>
-#include <iostream>
-#include <string>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-std::vector<std::array<size_t, 2>> read_ranges(const std::string& fname) {
-    // Read the file
-    std::vector<std::array<size_t, 2>> ranges;
-    std::string line;
-    std::ifstream ifile(fname);
-    while (std::getline(ifile, line)) {
-        if (line.empty()) break;
-        int mid = line.find('-');
-        size_t begin = std::stoull(line.substr(0,mid));
-        size_t end = std::stoull(line.substr(mid+1));
-        ranges.push_back({begin, end});
-    }
-    ifile.close();
+#include "aoc/binary.h"
+#include "aoc/day.h"
+#include "aoc/generator.h"
+#include "aoc/input.h"
+#include "aoc/parallel.h"
+#include "aoc/parse.h"
+
+#ifdef AOC_EMBED
+#include "aoc/embedded/day5.h"
+#endif
+
+namespace day5 {
+
+// Sorts the ranges and merges the ones that overlap or touch
+constexpr void merge_ranges(std::vector<std::array<size_t, 2>>& ranges) {
+    if (ranges.empty()) return;
     // Sort the ranges
     std::sort(ranges.begin(), ranges.end(), [](const std::array<size_t,2>& a, const std::array<size_t,2>& b) {
         return a[0] < b[0];
@@ -36,48 +42,59 @@ std::vector<std::array<size_t, 2>> read_ranges(const std::string& fname) {
             idx++;
         }
     }
-    return ranges;
 }
 
-std::vector<size_t> read_ingredients(const std::string& fname) {
-    std::string line;
-    std::ifstream ifile(fname);
-    bool ingredient_section = false;
-    std::vector<size_t> ingredients;
-    while (std::getline(ifile, line)) {
-        if (!ingredient_section) {
-            if (line.empty()) ingredient_section = true;
-            continue;
-        }
+constexpr std::vector<std::array<size_t, 2>> read_ranges(std::string_view input) {
+    // Read the file
+    std::vector<std::array<size_t, 2>> ranges;
+    for (std::string_view line : aoc::lines(input)) {
         if (line.empty()) break;
-        ingredients.push_back(std::stoull(line));
+        ranges.push_back(aoc::parse_range<size_t>(line));
     }
-    ifile.close();
-    return ingredients;
+    merge_ranges(ranges);
+    return ranges;
+}
+
+std::vector<size_t> read_ingredients(std::string_view input) {
+    // Skip the ranges, then parse the ingredients in pieces on the pool once
+    // there are a lot of them
+    aoc::Splitter lines(input);
+    std::string_view line;
+    while (lines.next(line) && !line.empty()) {}
+    return aoc::parallel::parallel_parse<size_t>(lines.remaining(), '\n', [](std::string_view piece, std::vector<size_t>& ingredients) {
+        for (std::string_view line : aoc::lines(piece)) {
+            if (line.empty()) return false;
+            ingredients.push_back(aoc::parse_int<size_t>(line));
+        }
+        return true;
+    });
+}
+
+// Ranges have to be merged
+bool is_fresh(const std::vector<std::array<size_t,2>>& ranges, size_t ingredient) {
+    auto idx = std::lower_bound(
+        ranges.begin(), 
+        ranges.end(), 
+        ingredient, 
+        [](const std::array<size_t,2>& range, const size_t& value){
+            return range[0] <= value;
+        }
+    );
+    size_t range_idx = static_cast<size_t> (idx - ranges.begin());
+    if (range_idx == 0) return false;
+    range_idx -= 1;
+    return ranges[range_idx][0] <= ingredient && ranges[range_idx][1] >= ingredient;
 }
 
 size_t fresh_ingredients(const std::vector<std::array<size_t,2>>& ranges, const std::vector<size_t>& ingredients) {
     size_t fresh_count = 0;
     for (const size_t& ingredient : ingredients) {
-        auto idx = std::lower_bound(
-            ranges.begin(), 
-            ranges.end(), 
-            ingredient, 
-            [](const std::array<size_t,2>& range, const size_t& value){
-                return range[0] <= value;
-            }
-        );
-        size_t range_idx = static_cast<size_t> (idx - ranges.begin());
-        if (range_idx == 0) continue;
-        range_idx -= 1;
-        if (ranges[range_idx][0] <= ingredient && ranges[range_idx][1] >= ingredient) {
-            fresh_count++;
-        }
+        if (is_fresh(ranges, ingredient)) fresh_count++;
     }
     return fresh_count;
 }
 
-size_t fresh_ids(const std::vector<std::array<size_t,2>>& ranges) {
+constexpr size_t fresh_ids(const std::vector<std::array<size_t,2>>& ranges) {
     size_t total = 0;
     for (const std::array<size_t,2>& range: ranges) {
         total += (range[1] - range[0] + 1);
@@ -85,25 +102,121 @@ size_t fresh_ids(const std::vector<std::array<size_t,2>>& ranges) {
     return total;
 }
 
-int main(int argc, char **argv) {
-    
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+struct Solver {
+    // The ranges, merged once the blank line after them is seen, and the
+    // fresh ingredients so far, saved between runs of the incremental mode
+    static constexpr uint32_t checkpoint_version = 1;
+    enum class Section : uint32_t { ranges, ingredients, done };
+    struct Checkpoint {
+        std::vector<std::array<size_t, 2>> ranges;
+        size_t fresh_count = 0;
+        Section section = Section::ranges;
+
+        void fold(std::string_view line) {
+            switch (section) {
+                case Section::ranges:
+                    if (line.empty()) {
+                        merge_ranges(ranges);
+                        section = Section::ingredients;
+                    }
+                    else {
+                        ranges.push_back(aoc::parse_range<size_t>(line));
+                    }
+                    break;
+                case Section::ingredients:
+                    if (line.empty()) {
+                        section = Section::done;
+                    }
+                    else if (is_fresh(ranges, aoc::parse_int<size_t>(line))) {
+                        fresh_count++;
+                    }
+                    break;
+                case Section::done:
+                    break;
+            }
+        }
+
+        std::pair<size_t, size_t> answers() const {
+            if (section != Section::ranges) return {fresh_count, fresh_ids(ranges)};
+            std::vector<std::array<size_t, 2>> merged = ranges;
+            merge_ranges(merged);
+            return {fresh_count, fresh_ids(merged)};
+        }
+    };
+
+    // No padding, so every byte written and checksummed is set
+    struct Counts {
+        uint64_t fresh_count;
+        Section section;
+        uint32_t reserved = 0;
+    };
+    static_assert(std::has_unique_object_representations_v<Counts>);
+
+    static void save(const Checkpoint& state, aoc::binary::Writer& out) {
+        out.add(state.ranges);
+        Counts counts = {.fresh_count = state.fresh_count, .section = state.section};
+        out.add(std::span<const Counts>(&counts, 1));
     }
 
-    // Read the input file
-    std::vector<std::array<size_t, 2>> ranges = read_ranges(argv[1]);
-    std::vector<size_t> ingredients = read_ingredients(argv[1]);
+    static Checkpoint restore(const aoc::binary::Reader& in) {
+        std::span<const std::array<size_t, 2>> ranges = in.section<std::array<size_t, 2>>(0);
+        std::span<const Counts> counts = in.section<Counts>(1);
+        if (counts.size() != 1) throw std::runtime_error("checkpoint: no counts");
+        return {
+            .ranges = {ranges.begin(), ranges.end()},
+            .fresh_count = counts[0].fresh_count,
+            .section = counts[0].section,
+        };
+    }
 
-    // Process the inputs
-    size_t num_fresh_ingredients = fresh_ingredients(ranges, ingredients);
-    size_t num_fresh_ids = fresh_ids(ranges);
+    struct Input {
+        std::vector<std::array<size_t, 2>> ranges;
+        std::vector<size_t> ingredients;
+    };
 
-    // Output the results
-    std::cout << "Fresh Ingredients: " << num_fresh_ingredients << std::endl;
-    std::cout << "Fresh IDs: " << num_fresh_ids << std::endl;
-    
-    return EXIT_SUCCESS;
-}
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return {
+            .ranges = bench.phase("read_ranges", [&] { return read_ranges(text); }),
+            .ingredients = bench.phase("read_ingredients", [&] { return read_ingredients(text); }),
+        };
+    }
+
+    static size_t part1(Input& input, aoc::bench::Harness& bench) {
+        return bench.phase("fresh_ingredients", [&] { return fresh_ingredients(input.ranges, input.ingredients); });
+    }
+
+    static size_t part2(Input& input, aoc::bench::Harness& bench) {
+        return bench.phase("fresh_ids", [&] { return fresh_ids(input.ranges); });
+    }
+
+    // The ranges have to be held to look the ingredients up in, but the
+    // ingredients are checked as they arrive and never stored
+    static std::pair<size_t, size_t> stream(aoc::Generator<std::string_view> lines) {
+        std::vector<std::array<size_t, 2>> ranges;
+        size_t fresh_count = 0;
+        bool ingredient_section = false;
+        for (std::string_view line : lines) {
+            if (!ingredient_section) {
+                if (line.empty()) {
+                    merge_ranges(ranges);
+                    ingredient_section = true;
+                    continue;
+                }
+                ranges.push_back(aoc::parse_range<size_t>(line));
+                continue;
+            }
+            if (line.empty()) break;
+            if (is_fresh(ranges, aoc::parse_int<size_t>(line))) fresh_count++;
+        }
+        if (!ingredient_section) merge_ranges(ranges);
+        return {fresh_count, fresh_ids(ranges)};
+    }
+};
+
+#ifdef AOC_EMBED
+static_assert(!embedded::has_example || fresh_ids(read_ranges(embedded::example)) == 14);
+#endif
+
+AOC_DAY(5, "Fresh Ingredients: ", "Fresh IDs: ");
+
+} // namespace day5
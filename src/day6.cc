@@ -1,24 +1,26 @@
-#include <fstream>
-#include <iostream>
-#include <string>
-#include <sstream>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#include "aoc/day.h"
+#include "aoc/generator.h"
+#include "aoc/input.h"
+#include "aoc/parse.h"
+
+namespace day6 {
+
 struct Instruction {
     std::vector<size_t> numbers;
     char operation;
 };
 
-std::vector<Instruction> read_input(const std::string& fname) {
-    // Read the file
-    std::ifstream ifile(fname);
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(ifile, line)) {
+std::vector<Instruction> read_input(std::string_view input) {
+    // Split the file into lines
+    std::vector<std::string_view> lines;
+    for (std::string_view line : aoc::lines(input)) {
         if (line.empty()) break;
         lines.push_back(line);
     }
-    ifile.close();
 
     // Get each operator and the width of each input
     size_t num_lines = lines.size();
@@ -40,26 +42,21 @@ std::vector<Instruction> read_input(const std::string& fname) {
     }
     for (size_t lnidx=0; lnidx<num_lines-1; lnidx++) {
         size_t op_idx = 0;
-        std::stringstream ss(lines[lnidx]);
-        size_t value = 0;
-        while (ss >> value) {
-            output[op_idx].numbers.push_back(value);
+        for (std::string_view value : aoc::words(lines[lnidx])) {
+            output[op_idx].numbers.push_back(aoc::parse_int<size_t>(value));
             op_idx++;
         }
     }
     return output;
 }
 
-std::vector<Instruction> read_cephalopod(const std::string& fname) {
-    // Read the file
-    std::ifstream ifile(fname);
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(ifile, line)) {
+std::vector<Instruction> read_cephalopod(std::string_view input) {
+    // Split the file into lines
+    std::vector<std::string_view> lines;
+    for (std::string_view line : aoc::lines(input)) {
         if (line.empty()) break;
         lines.push_back(line);
     }
-    ifile.close();
 
     // Get each operator and the width of each input
     size_t num_lines = lines.size();
@@ -125,25 +122,96 @@ size_t do_homework(const std::vector<Instruction>& instructions) {
     return total;
 }
 
-int main(int argc, char **argv) {
+// Both readings of the homework, folded a row at a time. Each problem keeps a
+// running sum and product of its numbers, and each character column the
+// cephalopod number read down it so far, so memory grows with the width of
+// the sheet but not its height. The operator row says which fold each
+// problem wanted.
+struct HomeworkFold {
+    std::vector<size_t> sums;
+    std::vector<size_t> products;
+    std::vector<size_t> columns;
+
+    void add_row(std::string_view line) {
+        size_t op_idx = 0;
+        for (std::string_view value : aoc::words(line)) {
+            size_t number = aoc::parse_int<size_t>(value);
+            if (op_idx == sums.size()) {
+                sums.push_back(0);
+                products.push_back(1);
+            }
+            sums[op_idx] += number;
+            products[op_idx] *= number;
+            op_idx++;
+        }
+        if (columns.size() < line.size()) columns.resize(line.size(), 0);
+        for (size_t ii=0; ii<line.size(); ii++) {
+            if (line[ii] != ' ') {
+                columns[ii] = columns[ii] * 10 + static_cast<size_t>(line[ii] - '0');
+            }
+        }
+    }
+
+    // Columns are split between the problems as in read_cephalopod
+    std::pair<size_t, size_t> finish(std::string_view operations) {
+        size_t total = 0;
+        size_t cephalopod_total = 0;
+        size_t op_idx = 0;
+        for (size_t ii=0; ii<operations.size(); ii++) {
+            char op = operations[ii];
+            if (op != '+' && op != '*') continue;
+            size_t end = operations.find_first_of("+*", ii+1);
+            end = (end == std::string_view::npos) ? operations.size() : end - 1;
+            size_t sub_total = (op == '+') ? 0 : 1;
+            for (size_t col=ii; col<end; col++) {
+                size_t number = (col < columns.size()) ? columns[col] : 0;
+                sub_total = (op == '+') ? sub_total + number : sub_total * number;
+            }
+            cephalopod_total += sub_total;
+            if (op_idx < sums.size()) {
+                total += (op == '+') ? sums[op_idx] : products[op_idx];
+            }
+            op_idx++;
+        }
+        return {total, cephalopod_total};
+    }
+};
+
+struct Solver {
+    struct Input {
+        std::vector<Instruction> instructions;
+        std::vector<Instruction> cephalopod_instructions;
+    };
+
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return {
+            .instructions = bench.phase("read_input", [&] { return read_input(text); }),
+            .cephalopod_instructions = bench.phase("read_cephalopod", [&] { return read_cephalopod(text); }),
+        };
+    }
 
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+    static size_t part1(Input& input, aoc::bench::Harness& bench) {
+        return bench.phase("do_homework", [&] { return do_homework(input.instructions); });
     }
 
-    // Read the input file
-    std::vector<Instruction> instructions  = read_input(argv[1]);
-    std::vector<Instruction> cephalopod_instructions = read_cephalopod(argv[1]);
+    static size_t part2(Input& input, aoc::bench::Harness& bench) {
+        return bench.phase("do_homework (cephalopod)", [&] { return do_homework(input.cephalopod_instructions); });
+    }
 
-    // Process the inputs
-    size_t answer = do_homework(instructions);
-    size_t cephalopod_answer = do_homework(cephalopod_instructions);
+    // Number rows until the operator row
+    static std::pair<size_t, size_t> stream(aoc::Generator<std::string_view> lines) {
+        HomeworkFold fold;
+        for (std::string_view line : lines) {
+            if (line.empty()) break;
+            if (line.find_first_of("+*") != std::string_view::npos) {
+                return fold.finish(line);
+            }
+            fold.add_row(line);
+        }
+        return {0, 0};
+    }
+};
 
-    // Output the results
-    std::cout << "Answer: " << answer << std::endl;
-    std::cout << "Cephalopod Answer: " << cephalopod_answer << std::endl;
+AOC_DAY(6, "Answer: ", "Cephalopod Answer: ");
 
-    return EXIT_SUCCESS;
-}
+} // namespace day6
@@ -1,44 +1,45 @@
+#include <cstddef>
 #include <cstdint>
-#include <fstream>
-#include <iostream>
-#include <string>
-#include <vector>
+#include <string_view>
+
+#include "aoc/day.h"
+#include "aoc/grid.h"
+#include "aoc/input.h"
 
 #ifdef DEBUG
 #include <iomanip>
+#include <iostream>
 #endif // DEBUG
 
-std::vector<std::string> read_input(const std::string& fname) {
-    // Read the file
-    std::ifstream ifile(fname);
-    std::vector<std::string> lines;
-    std::string line;
-    while (std::getline(ifile, line)) {
-        if (line.empty()) break;
-        lines.push_back(line);
-    }
-    ifile.close();
-    return lines;
+#ifdef AOC_EMBED
+#include "aoc/embedded/day7.h"
+#endif
+
+namespace day7 {
+
+// The manifold with a border of empty space, so a splitter in the first or
+// last column sends its beams into the border rather than out of bounds
+constexpr aoc::Grid<char> read_input(std::string_view input) {
+    return aoc::read_grid(input, 1, '.');
 }
 
-size_t count_splits(const std::vector<std::string>& data) {
-    std::vector<std::string> local_data = data;
+constexpr size_t count_splits(const aoc::Grid<char>& data) {
+    aoc::Grid<char> local_data = data;
+    ptrdiff_t width = static_cast<ptrdiff_t>(local_data.width());
+    ptrdiff_t height = static_cast<ptrdiff_t>(local_data.height());
     size_t splits = 0;
-    for (size_t row=0; row<local_data.size()-1; row++) {
-        for (size_t col=0; col<local_data[row].length(); col++) {
-            char& upper = local_data[row][col];
-            char& lower = local_data[row+1][col];
-            char& left = local_data[row+1][col-1];
-            char& right = local_data[row+1][col+1];
-
-            if (upper == 'S' || upper == '|') {
-                if (lower == '.') {
-                    lower = '|';
+    for (ptrdiff_t row=0; row<height-1; row++) {
+        const char* upper = local_data.row(row);
+        char* lower = local_data.row(row+1);
+        for (ptrdiff_t col=0; col<width; col++) {
+            if (upper[col] == 'S' || upper[col] == '|') {
+                if (lower[col] == '.') {
+                    lower[col] = '|';
                 }
-                else if (lower == '^') {
+                else if (lower[col] == '^') {
                     splits++;
-                    left = '|';
-                    right = '|';
+                    lower[col-1] = '|';
+                    lower[col+1] = '|';
                 }
             }
         }
@@ -46,43 +47,36 @@ size_t count_splits(const std::vector<std::string>& data) {
     return splits;
 }
 
-size_t count_timelines(const std::vector<std::string>& data) {
+size_t count_timelines(const aoc::Grid<char>& data) {
+    ptrdiff_t width = static_cast<ptrdiff_t>(data.width());
+    ptrdiff_t height = static_cast<ptrdiff_t>(data.height());
 
     // Convert data to a more useful form
-    std::vector<std::vector<int64_t>> local_data;
-    for (size_t row=0; row<data.size(); row++) {
-        std::vector<int64_t> row_data;
-        for (size_t col=0; col<data[row].length(); col++) {
-            char value = data[row][col];
+    aoc::Grid<int64_t> local_data(data.width(), data.height(), 1, 0);
+    for (ptrdiff_t row=0; row<height; row++) {
+        for (ptrdiff_t col=0; col<width; col++) {
+            char value = data(col, row);
             if (value == 'S' || value == '|') {
-                row_data.push_back(1);
+                local_data(col, row) = 1;
             }
             else if (value == '^') {
-                row_data.push_back(-1);
-            }
-            else
-            {
-                row_data.push_back(0);
+                local_data(col, row) = -1;
             }
         }
-        local_data.push_back(row_data);
     }
 
     // Split the beams
-    for (size_t row=0; row<local_data.size()-1; row++) {
-        for (size_t col=0; col<local_data[row].size(); col++) {
-            int64_t& upper = local_data[row][col];
-            int64_t& lower = local_data[row+1][col];
-            int64_t& left = local_data[row+1][col-1];
-            int64_t& right = local_data[row+1][col+1];
-
-            if (upper > 0) {
-                if (lower != -1) {
-                    lower += upper;
+    for (ptrdiff_t row=0; row<height-1; row++) {
+        const int64_t* upper = local_data.row(row);
+        int64_t* lower = local_data.row(row+1);
+        for (ptrdiff_t col=0; col<width; col++) {
+            if (upper[col] > 0) {
+                if (lower[col] != -1) {
+                    lower[col] += upper[col];
                 }
                 else {
-                    left += upper;
-                    right += upper;
+                    lower[col-1] += upper[col];
+                    lower[col+1] += upper[col];
                 }
             }
         }
@@ -90,9 +84,9 @@ size_t count_timelines(const std::vector<std::string>& data) {
 
 #ifdef DEBUG
     // Print the map
-    for (size_t row=0; row<local_data.size()-1; row++) {
-        for (size_t col=0; col<local_data[row].size(); col++) {
-            std::cout << std::setw(20) << local_data[row][col];
+    for (ptrdiff_t row=0; row<height-1; row++) {
+        for (ptrdiff_t col=0; col<width; col++) {
+            std::cout << std::setw(20) << local_data(col, row);
         }
         std::cout << std::endl;
     }
@@ -100,32 +94,33 @@ size_t count_timelines(const std::vector<std::string>& data) {
     
     // Cound the timelines
     int64_t timelines = 0;
-    size_t last_row = local_data.size()-1;
-    for (size_t col=0; col<local_data[last_row].size(); col++) {
-        int64_t value = local_data[last_row][col];
-        if (value > 0) timelines += static_cast<size_t>(value);
+    const int64_t* last_row = local_data.row(height-1);
+    for (ptrdiff_t col=0; col<width; col++) {
+        if (last_row[col] > 0) timelines += last_row[col];
     }
-    return timelines;
+    return static_cast<size_t>(timelines);
 }
 
-int main(int argc, char **argv) {
+struct Solver {
+    using Input = aoc::Grid<char>;
 
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return bench.phase("read_input", [&] { return read_input(text); });
     }
 
-    // Read the input file
-    std::vector<std::string> data = read_input(argv[1]);
+    static size_t part1(Input& data, aoc::bench::Harness& bench) {
+        return bench.phase("count_splits", [&] { return count_splits(data); });
+    }
 
-    // Process the inputs
-    size_t splits = count_splits(data);
-    size_t result2 = count_timelines(data);
+    static size_t part2(Input& data, aoc::bench::Harness& bench) {
+        return bench.phase("count_timelines", [&] { return count_timelines(data); });
+    }
+};
 
-    // Output the results
-    std::cout << "Splits: " << splits << std::endl;
-    std::cout << "Timelines: " << result2 << std::endl;
+#ifdef AOC_EMBED
+static_assert(!embedded::has_example || count_splits(read_input(embedded::example)) == 21);
+#endif
 
-    return EXIT_SUCCESS;
-}
+AOC_DAY(7, "Splits: ", "Timelines: ");
+
+} // namespace day7
@@ -1,72 +1,82 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
-#include <fstream>
-#include <iostream>
-#include <sstream>
-#include <string>
-#include <tuple>
+#include <memory_resource>
+#include <span>
+#include <string_view>
 #include <unordered_set>
 #include <vector>
 
+#include "aoc/arena.h"
+#include "aoc/binary.h"
+#include "aoc/cache.h"
+#include "aoc/day.h"
+#include "aoc/input.h"
+#include "aoc/parallel.h"
+#include "aoc/parse.h"
+#include "aoc/points.h"
+#include "aoc/simd.h"
+
+namespace day8 {
+
 using Point3D = std::array<uint64_t, 3>;
 
-std::vector<Point3D> read_input(const std::string& fname) {
-    // Read the file
-    std::ifstream ifile(fname);
-    std::string line;
-    std::vector<std::array<uint64_t, 3>> output;
-    while (std::getline(ifile, line)) {
-        if (line.empty()) break;
-        std::stringstream ss(line);
-        output.push_back({0, 0, 0});
-        for (size_t ii=0; ii<3; ii++){
-            std::string cell;
-            std::getline(ss, cell, ',');
-            output[output.size()-1][ii] = std::stoull(cell);
+std::vector<Point3D> read_input(std::string_view input) {
+    // Read the file, in pieces on the pool once it is large
+    return aoc::parallel::parallel_parse<Point3D>(input, '\n', [](std::string_view piece, std::vector<Point3D>& points) {
+        for (std::string_view line : aoc::lines(piece)) {
+            if (line.empty()) return false;
+            points.push_back(aoc::parse_fields<uint64_t, 3>(line, ','));
         }
-    }
-    ifile.close();
-    return output;
-}
-
-uint64_t point_distance(const Point3D& p1, const Point3D& p2) {
-        uint64_t dx = p2[0] - p1[0];
-        uint64_t dy = p2[1] - p1[1];
-        uint64_t dz = p2[2] - p1[2];
-        return dx*dx + dy*dy + dz*dz;
+        return true;
+    });
 }
 
 using IndexPair = std::array<size_t, 2>;
-using DistanceInfo = std::tuple<uint64_t, IndexPair>;
-
-std::vector<DistanceInfo> get_distances(const std::vector<Point3D>& nodes) {
-    // Calculate all the distances
-    std::vector<DistanceInfo> distances;
-    for (size_t ii=0; ii<nodes.size()-1; ii++) {
-        for (size_t jj=(ii+1); jj<nodes.size(); jj++) {
-            uint64_t dist = point_distance(nodes[ii], nodes[jj]);
-            DistanceInfo value = {
-                dist, {ii, jj}
+// Plain struct rather than a tuple so the sorted list can be cached as bytes
+struct DistanceInfo {
+    uint64_t distance;
+    IndexPair pair;
+};
+
+std::vector<DistanceInfo> get_distances(std::span<const Point3D> nodes) {
+    // One array per coordinate (aoc/points.h), so the squared distances from
+    // a node to a tile of the ones after it are a vector kernel (aoc/simd.h).
+    // Each row goes where the pair comes in ii, jj order.
+    aoc::Points<uint64_t, 3> points(nodes);
+    size_t count = points.size();
+    const uint64_t* xs = points.coord(0);
+    const uint64_t* ys = points.coord(1);
+    const uint64_t* zs = points.coord(2);
+    std::vector<DistanceInfo> distances(aoc::pair_count(count));
+    std::vector<uint64_t> row(aoc::PAIR_TILE);
+    aoc::for_each_pair_tile(count, [&](size_t ii, size_t begin, size_t end) {
+        aoc::simd::squared_distances(xs + begin, ys + begin, zs + begin, end - begin, xs[ii], ys[ii], zs[ii], row.data());
+        DistanceInfo* out = &distances[aoc::pair_offset(count, ii) + (begin - ii - 1)];
+        for (size_t jj=begin; jj<end; jj++) {
+            out[jj-begin] = {
+                .distance = row[jj-begin],
+                .pair = {ii, jj},
             };
-            distances.push_back(value);
         }
-    }
+    });
     // Sort the list
     std::sort(
         distances.begin(),
         distances.end(),
         [](const DistanceInfo& a, const DistanceInfo& b) {
-            return std::get<0>(a) < std::get<0>(b);
+            return a.distance < b.distance;
         }
     );
     return distances;
 }
 
-using Circuit = std::unordered_set<size_t>;
+// Circuits and their sets are allocated from the arena of the caller
+using Circuit = std::pmr::unordered_set<size_t>;
+using Circuits = std::pmr::vector<Circuit>;
 
-void make_connection(IndexPair pair, std::vector<Circuit>& circuits) {
-    std::vector<int> circuit_idxs = {-1, -1};
+void make_connection(IndexPair pair, Circuits& circuits) {
+    std::array<int, 2> circuit_idxs = {-1, -1};
     size_t circuit_idx = 0;
     // Find if the indexs are alread in a circuit
     for (const Circuit& circuit : circuits) {
@@ -82,8 +92,7 @@ void make_connection(IndexPair pair, std::vector<Circuit>& circuits) {
     }
     // Put the indexs into the list
     if (circuit_idxs[0] == -1 && circuit_idxs[1] == -1) {
-        Circuit new_circuit = {pair[0], pair[1]};
-        circuits.push_back(new_circuit);
+        circuits.emplace_back().insert({pair[0], pair[1]});
     }
     else if (circuit_idxs[0] == circuit_idxs[1]) {
         // Do nothing, already connected
@@ -106,9 +115,10 @@ void make_connection(IndexPair pair, std::vector<Circuit>& circuits) {
 uint64_t do_n_connections(const std::vector<DistanceInfo>& distances, const size_t n) {
 
     // Loop through the first 'n' distances and make circuits
-    std::vector<Circuit> circuits;
+    aoc::Arena arena("day8/do_n_connections");
+    Circuits circuits(arena.resource());
     for (size_t ii=0; ii<n; ii++) {
-        IndexPair pair = std::get<1>(distances[ii]);
+        IndexPair pair = distances[ii].pair;
         make_connection(pair, circuits);
     }
 
@@ -129,13 +139,14 @@ uint64_t do_n_connections(const std::vector<DistanceInfo>& distances, const size
     return product;
 }
 
-uint64_t find_last_connection(const std::vector<Point3D>& junctions, const std::vector<DistanceInfo>& dist_info) {
-    std::unordered_set<size_t> connected_nodes;
-    std::vector<Circuit> circuits;
+uint64_t find_last_connection(std::span<const Point3D> junctions, const std::vector<DistanceInfo>& dist_info) {
+    aoc::Arena arena("day8/find_last_connection");
+    std::pmr::unordered_set<size_t> connected_nodes(arena.resource());
+    Circuits circuits(arena.resource());
     size_t x1 = 0;
     size_t x2 = 0;
     for (size_t ii=0; ii<dist_info.size(); ii++) {
-        IndexPair pair = std::get<1>(dist_info[ii]);
+        IndexPair pair = dist_info[ii].pair;
         make_connection(pair, circuits);
         connected_nodes.insert(
             pair.begin(), pair.end()
@@ -149,25 +160,47 @@ uint64_t find_last_connection(const std::vector<Point3D>& junctions, const std::
     return x1 * x2;
 }
 
-int main(int argc, char **argv) {
+struct Solver {
+    // part1 leaves the sorted distances behind for part2
+    struct Input {
+        aoc::binary::Array<Point3D> junction_boxes;
+        std::vector<DistanceInfo> distances;
+    };
+
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return {
+            .junction_boxes = aoc::binary::Array<Point3D>(bench.phase("read_input", [&] { return read_input(text); })),
+            .distances = {},
+        };
+    }
 
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+    // The binary input is just the points
+    static constexpr uint32_t binary_version = 1;
+
+    static void compile(const Input& input, aoc::binary::Writer& out) {
+        out.add(input.junction_boxes.span());
+    }
+
+    static Input load(const aoc::binary::Reader& in) {
+        return {
+            .junction_boxes = aoc::binary::Array<Point3D>(in.section<Point3D>(0)),
+            .distances = {},
+        };
     }
 
-    // Read the input file
-    std::vector<Point3D> junction_boxes = read_input(argv[1]);
-    std::vector<DistanceInfo> distances = get_distances(junction_boxes);
+    static uint64_t part1(Input& input, aoc::bench::Harness& bench) {
+        input.distances = bench.phase("get_distances", [&] {
+            return aoc::cache::artifact<DistanceInfo>("distances", 1, [&] { return get_distances(input.junction_boxes); });
+        });
+        bench.items("pairs", aoc::pair_count(input.junction_boxes.size()));
+        return bench.phase("do_n_connections", [&] { return do_n_connections(input.distances, 1000); });
+    }
 
-    // Process the inputs
-    uint64_t product = do_n_connections(distances, 1000);
-    uint64_t wall_distance = find_last_connection(junction_boxes, distances);
+    static uint64_t part2(Input& input, aoc::bench::Harness& bench) {
+        return bench.phase("find_last_connection", [&] { return find_last_connection(input.junction_boxes, input.distances); });
+    }
+};
 
-    // Output the results
-    std::cout << "Circuit product: " << product << std::endl;
-    std::cout << "Wall Distance: " << wall_distance << std::endl;
+AOC_DAY(8, "Circuit product: ", "Wall Distance: ");
 
-    return EXIT_SUCCESS;
-}
+} // namespace day8
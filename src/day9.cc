@@ -1,31 +1,33 @@
 #include <algorithm>
 #include <array>
 #include <cstdint>
-#include <fstream>
-#include <iostream>
 #include <set>
-#include <sstream>
-#include <string>
+#include <span>
+#include <string_view>
 #include <vector>
 
+#include "aoc/binary.h"
+#include "aoc/cache.h"
+#include "aoc/day.h"
+#include "aoc/input.h"
+#include "aoc/parallel.h"
+#include "aoc/parse.h"
+#include "aoc/points.h"
+#include "aoc/simd.h"
+#include "aoc/trace.h"
+
+namespace day9 {
+
 using Point2D = std::array<int64_t, 2>;
-std::vector<Point2D> read_input(const std::string& fname) {
-    // Read the file
-    std::ifstream ifile(fname);
-    std::string line;
-    std::vector<std::array<int64_t, 2>> output;
-    while (std::getline(ifile, line)) {
-        if (line.empty()) break;
-        std::stringstream ss(line);
-        output.push_back({0, 0});
-        for (size_t ii=0; ii<2; ii++){
-            std::string cell;
-            std::getline(ss, cell, ',');
-            output[output.size()-1][ii] = std::stoll(cell);
+std::vector<Point2D> read_input(std::string_view input) {
+    // Read the file, in pieces on the pool once it is large
+    return aoc::parallel::parallel_parse<Point2D>(input, '\n', [](std::string_view piece, std::vector<Point2D>& tiles) {
+        for (std::string_view line : aoc::lines(piece)) {
+            if (line.empty()) return false;
+            tiles.push_back(aoc::parse_fields<int64_t, 2>(line, ','));
         }
-    }
-    ifile.close();
-    return output;
+        return true;
+    });
 }
 
 struct RectInfo {
@@ -34,27 +36,35 @@ struct RectInfo {
 };
 
 int64_t find_largest_area(
-    const std::vector<Point2D>& tiles,
+    std::span<const Point2D> tiles,
     std::vector<RectInfo>* rect_list = nullptr
 ) {
+    // One array per coordinate (aoc/points.h), so the areas from a tile to a
+    // tile of the ones after it are a vector kernel (aoc/simd.h). Each row
+    // goes where the pair comes in ii, jj order.
+    aoc::Points<int64_t, 2> points(tiles);
+    size_t count = points.size();
+    const int64_t* xs = points.coord(0);
+    const int64_t* ys = points.coord(1);
+    if (rect_list != nullptr) {
+        rect_list->resize(aoc::pair_count(count));
+    }
     int64_t largest_area = 0;
-    for (size_t ii=0; ii<tiles.size()-1; ii++) {
-        for (size_t jj=(ii+1); jj<tiles.size(); jj++) {
-            int64_t w = std::abs(tiles[ii][0] - tiles[jj][0]) + 1;
-            int64_t h = std::abs(tiles[ii][1] - tiles[jj][1]) + 1;
-            int64_t area = w * h;
-            if (area > largest_area) {
-                largest_area = area;
-            }
-            if (rect_list != nullptr) {
-                RectInfo ri = {
+    std::vector<int64_t> row(aoc::PAIR_TILE);
+    aoc::for_each_pair_tile(count, [&](size_t ii, size_t begin, size_t end) {
+        aoc::simd::rect_areas(xs + begin, ys + begin, end - begin, xs[ii], ys[ii], row.data());
+        RectInfo* out = rect_list ? &(*rect_list)[aoc::pair_offset(count, ii) + (begin - ii - 1)] : nullptr;
+        for (size_t jj=begin; jj<end; jj++) {
+            int64_t area = row[jj-begin];
+            largest_area = std::max(largest_area, area);
+            if (out != nullptr) {
+                out[jj-begin] = {
                     .area = area,
                     .pt_idx = {ii, jj},
                 };
-                rect_list->push_back(ri);
             }
         }
-    }
+    });
     if (rect_list != nullptr) {
         std::sort(
             rect_list->begin(),
@@ -142,7 +152,7 @@ bool trace_ray(
 }
 
 int64_t find_largest_contained_rect(
-    const std::vector<Point2D>& tiles,
+    std::span<const Point2D> tiles,
     const std::vector<RectInfo>& rects
 ) {
     // Ray tracing solution with pre-sorting of vertical polygon segments to 
@@ -261,7 +271,10 @@ int64_t find_largest_contained_rect(
         bool trace_ok = true;
         int64_t x_start = std::min(pt1[0], pt2[0]);
         int64_t x_end = std::max(pt1[0], pt2[0]);
+        AOC_TRACE_COUNT("day9/find_largest_contained_rect/rects_tested", 1);
+        AOC_TRACE_HIST("day9/find_largest_contained_rect/segments_per_rect", vseg_select.size());
         for (auto tp=tp_begin; tp!=tp_end; tp++) {
+            AOC_TRACE_COUNT("day9/find_largest_contained_rect/rays_traced", 1);
             trace_ok = trace_ray(*tp, x_start, x_end, vseg_select);
             if (!trace_ok) break;
         }
@@ -272,25 +285,53 @@ int64_t find_largest_contained_rect(
     return 0;
 }
 
-int main(int argc, char **argv) {
+struct Solver {
+    // part1 leaves the sorted rectangles behind for part2
+    struct Input {
+        aoc::binary::Array<Point2D> tiles;
+        std::vector<RectInfo> rect_info;
+    };
+
+    static Input parse(std::string_view text, aoc::bench::Harness& bench) {
+        return {
+            .tiles = aoc::binary::Array<Point2D>(bench.phase("read_input", [&] { return read_input(text); })),
+            .rect_info = {},
+        };
+    }
+
+    // The binary input is just the tiles
+    static constexpr uint32_t binary_version = 1;
+
+    static void compile(const Input& input, aoc::binary::Writer& out) {
+        out.add(input.tiles.span());
+    }
 
-    // Check inputs
-    if (argc != 2) {
-        std::cout << "Input filename must be provided" << std::endl;
-        return EXIT_FAILURE;
+    static Input load(const aoc::binary::Reader& in) {
+        return {
+            .tiles = aoc::binary::Array<Point2D>(in.section<Point2D>(0)),
+            .rect_info = {},
+        };
     }
 
-    // Read the input file
-    std::vector<Point2D> tiles = read_input(argv[1]);
-    std::vector<RectInfo> rect_info;
+    static int64_t part1(Input& input, aoc::bench::Harness& bench) {
+        int64_t largest = bench.phase("find_largest_area", [&] {
+            input.rect_info = aoc::cache::artifact<RectInfo>("rect_info", 1, [&] {
+                std::vector<RectInfo> rect_info;
+                find_largest_area(input.tiles, &rect_info);
+                return rect_info;
+            });
+            // Sorted largest first
+            return input.rect_info.empty() ? int64_t{0} : input.rect_info.front().area;
+        });
+        bench.items("pairs", aoc::pair_count(input.tiles.size()));
+        return largest;
+    }
 
-    // Process the inputs
-    int64_t largest_area = find_largest_area(tiles, &rect_info);
-    int64_t largest_bounded_rect = find_largest_contained_rect(tiles, rect_info);
+    static int64_t part2(Input& input, aoc::bench::Harness& bench) {
+        return bench.phase("find_largest_contained_rect", [&] { return find_largest_contained_rect(input.tiles, input.rect_info); });
+    }
+};
 
-    // Output the results
-    std::cout << "Largest Area: " << largest_area << std::endl;
-    std::cout << "Largest Bounded Rect: " << largest_bounded_rect << std::endl;
+AOC_DAY(9, "Largest Area: ", "Largest Bounded Rect: ");
 
-    return EXIT_SUCCESS;
-}
+} // namespace day9
@@ -0,0 +1,128 @@
+// Runs any number of days in one process, concurrently on a thread pool
+//
+// Usage: aoc [-e] [-j threads] [-d data_dir] [--clear-cache] [day ...]
+//
+// With no days given every day that has an input file is run. Each day's
+// answers are printed in order along with the wall time it took, followed by
+// the wall time for the whole batch. Answers come from the result cache when
+// AOC_CACHE_DIR is set (see aoc/cache.h).
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "aoc/cache.h"
+#include "aoc/day.h"
+#include "aoc/input.h"
+#include "aoc/memstats_hooks.h"
+#include "aoc/parallel.h"
+#include "aoc/sampler.h"
+#include "aoc/registry.h"
+#include "aoc/trace.h"
+
+struct DayRun {
+    int day;
+    std::string output;
+    double millis;
+};
+
+DayRun run_day(const aoc::Day& day, const std::string& fname, const aoc::cache::Cache& cache) {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    std::ostringstream out;
+    try {
+        aoc::bench::Harness bench(day.name, fname);
+        aoc::MappedFile input(fname);
+        aoc::Answers answers = aoc::solve_cached(day, input.view(), bench, cache);
+        aoc::write_answers(day, answers, out);
+    }
+    catch (const std::exception& err) {
+        out << "Error: " << err.what() << "\n";
+    }
+    std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+    return {day.number, out.str(), elapsed.count()};
+}
+
+void usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [-e] [-j threads] [-d data_dir] [--clear-cache] [day ...]\n"
+              << "  -e             Use example.dat instead of input.dat\n"
+              << "  -j threads     Worker threads (default: one per core)\n"
+              << "  -d data_dir    Directory holding dayN/ (default: data)\n"
+              << "  --clear-cache  Empty AOC_CACHE_DIR and exit\n";
+}
+
+int main(int argc, char **argv) {
+
+    // Check inputs
+    std::string data_dir = "data";
+    std::string data_file = "input.dat";
+    size_t threads = 0;
+    std::vector<int> days;
+    aoc::cache::Cache cache;
+    for (int ii=1; ii<argc; ii++) {
+        std::string_view arg = argv[ii];
+        if (arg == "-h" || arg == "--help") {
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        }
+        else if (arg == "-e" || arg == "--example") {
+            data_file = "example.dat";
+        }
+        else if ((arg == "-j" || arg == "--jobs") && ii+1 < argc) {
+            threads = std::strtoull(argv[++ii], nullptr, 10);
+        }
+        else if ((arg == "-d" || arg == "--data") && ii+1 < argc) {
+            data_dir = argv[++ii];
+        }
+        else if (arg == "--clear-cache") {
+            cache.clear();
+            return EXIT_SUCCESS;
+        }
+        else {
+            int day = std::atoi(argv[ii]);
+            if (aoc::find_day(day) == nullptr) {
+                usage(argv[0]);
+                return EXIT_FAILURE;
+            }
+            days.push_back(day);
+        }
+    }
+    auto input_path = [&](int day) {
+        return data_dir + "/day" + std::to_string(day) + "/" + data_file;
+    };
+    if (days.empty()) {
+        for (const aoc::Day* day : aoc::days()) {
+            if (std::filesystem::exists(input_path(day->number))) days.push_back(day->number);
+        }
+    }
+
+    // Run everything on the shared pool, which the days' own parallel loops
+    // use too, so -j threads in all do the work
+    aoc::parallel::init_pool(threads);
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point start = Clock::now();
+    std::vector<DayRun> runs(days.size());
+    aoc::parallel::pool().run(days.size(), [&](size_t ii) {
+        runs[ii] = run_day(*aoc::find_day(days[ii]), input_path(days[ii]), cache);
+    });
+    std::chrono::duration<double, std::milli> total = Clock::now() - start;
+
+    // Print the results in order
+    double sum = 0;
+    for (const DayRun& run : runs) {
+        sum += run.millis;
+        std::cout << "== Day " << run.day << " (" << std::fixed << std::setprecision(3)
+                  << run.millis << " ms)\n" << run.output;
+    }
+    std::cout << "\nWall time: " << std::fixed << std::setprecision(3) << total.count() << " ms"
+              << " (" << sum << " ms across " << runs.size() << " days)" << std::endl;
+    aoc::trace::report();
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+// Sends one input to the solver daemon and prints the answers
+//
+// Usage: aoc_client [-s socket] [-t] <day> <input file>
+//
+// The answers are printed exactly as the day's own executable prints them.
+// With -t the time the daemon spent on the request and the round trip time
+// seen by the client follow on stderr.
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+#include "aoc/input.h"
+#include "aoc/protocol.h"
+
+namespace protocol = aoc::protocol;
+
+int main(int argc, char **argv) {
+
+    // Check inputs
+    std::string path = protocol::default_socket_path();
+    bool timing = false;
+    std::vector<std::string> args;
+    for (int ii=1; ii<argc; ii++) {
+        std::string_view arg = argv[ii];
+        if (arg == "-s" && ii+1 < argc) {
+            path = argv[++ii];
+        }
+        else if (arg == "-t") {
+            timing = true;
+        }
+        else {
+            args.push_back(argv[ii]);
+        }
+    }
+    if (args.size() != 2) {
+        std::cout << "Usage: " << argv[0] << " [-s socket] [-t] <day> <input file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    using Clock = std::chrono::steady_clock;
+    try {
+        aoc::MappedFile input(args[1]);
+        int fd = protocol::connect_to(path);
+        Clock::time_point start = Clock::now();
+        protocol::ResponseHeader header;
+        std::string text;
+        bool ok = protocol::send_request(fd, static_cast<uint32_t>(std::stoul(args[0])), input.view()) &&
+                  protocol::read_response(fd, header, text);
+        std::chrono::duration<double, std::micro> round_trip = Clock::now() - start;
+        ::close(fd);
+        if (!ok) {
+            std::cout << "Lost the connection to " << path << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << text << std::flush;
+        if (timing) {
+            std::cerr << std::fixed << std::setprecision(1)
+                      << "server " << static_cast<double>(header.server_ns) / 1e3 << " us, "
+                      << "round trip " << round_trip.count() << " us" << std::endl;
+        }
+        return header.status == protocol::Status::ok ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch (const std::exception& err) {
+        std::cout << "Error: " << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,62 @@
+// Converts a day's text input into its pre-parsed binary input
+//
+// Usage: aoc_compile <day> <input> <output>
+//
+// The output can be given to the day's executable, the aoc driver or the
+// daemon anywhere a text input goes. See aoc/binary.h for the format. Days
+// without a binary format are refused.
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "aoc/day.h"
+#include "aoc/input.h"
+#include "aoc/registry.h"
+
+int main(int argc, char **argv) {
+
+    // Check inputs
+    if (argc != 4) {
+        std::cout << "Usage: " << argv[0] << " <day> <input> <output>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    const aoc::Day* day = aoc::find_day(std::atoi(argv[1]));
+    if (day == nullptr) {
+        std::cout << "No day " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (day->compile == nullptr) {
+        std::cout << day->name << " has no binary input format" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Parse the input and write it out, through a temporary file so a failed
+    // run never leaves a partial one behind
+    try {
+        aoc::MappedFile input(argv[2]);
+        std::string bytes = day->compile(input.view());
+        std::filesystem::path path = argv[3];
+        if (path.has_parent_path()) std::filesystem::create_directories(path.parent_path());
+        std::filesystem::path tmp = path;
+        tmp += ".tmp";
+        {
+            std::ofstream ofile(tmp, std::ios::binary);
+            ofile.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+            if (!ofile) {
+                std::cout << "Error: could not write " << tmp.string() << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+        std::filesystem::rename(tmp, path);
+        std::cout << day->name << ": " << input.size() << " bytes of text to " << bytes.size() << " bytes in " << path.string() << std::endl;
+    }
+    catch (const std::exception& err) {
+        std::cout << "Error: " << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
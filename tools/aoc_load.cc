@@ -0,0 +1,215 @@
+// Load test for the solver daemon
+//
+// Usage: aoc_load [-s socket] [-c clients] [-n requests] [-e] [-d data_dir] [day ...]
+//
+// Starts clients threads (default 4), each with its own connection, and has
+// each send requests inputs (default 100) back to back, cycling through the
+// days' input files (every day with one when none are given). Reports the
+// throughput, the round trip latency percentiles per day and overall, and the
+// median time the daemon itself spent per request. Every answer must match the
+// first one the daemon gave for that day, anything else counts as a failure
+// and makes the run fail.
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "aoc/input.h"
+#include "aoc/protocol.h"
+
+namespace protocol = aoc::protocol;
+
+struct Sample {
+    int day;
+    int64_t round_trip_ns;
+    int64_t server_ns;
+};
+
+struct Job {
+    int day;
+    std::string path;
+    aoc::MappedFile input;
+};
+
+// Value at fraction q of sorted values
+int64_t percentile(const std::vector<int64_t>& sorted, double q) {
+    size_t idx = static_cast<size_t>(q * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(idx, sorted.size() - 1)];
+}
+
+void print_row(std::ostream& out, const std::string& name, std::vector<int64_t> round_trips, std::vector<int64_t> server) {
+    std::sort(round_trips.begin(), round_trips.end());
+    std::sort(server.begin(), server.end());
+    auto us = [](int64_t ns) { return static_cast<double>(ns) / 1e3; };
+    out << std::left << std::setw(8) << name << std::right << std::setw(10) << round_trips.size()
+        << std::fixed << std::setprecision(1)
+        << std::setw(12) << us(round_trips.front())
+        << std::setw(12) << us(percentile(round_trips, 0.5))
+        << std::setw(12) << us(percentile(round_trips, 0.9))
+        << std::setw(12) << us(percentile(round_trips, 0.99))
+        << std::setw(12) << us(round_trips.back())
+        << std::setw(14) << us(percentile(server, 0.5)) << "\n";
+}
+
+void usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [-s socket] [-c clients] [-n requests] [-e] [-d data_dir] [day ...]\n"
+              << "  -s socket     Daemon socket (default: $AOC_SOCKET or " << protocol::default_socket_path() << ")\n"
+              << "  -c clients    Concurrent connections (default: 4)\n"
+              << "  -n requests   Requests per connection (default: 100)\n"
+              << "  -e            Use example.dat instead of input.dat\n"
+              << "  -d data_dir   Directory holding dayN/ (default: data)\n";
+}
+
+int main(int argc, char **argv) {
+
+    // Check inputs
+    std::string path = protocol::default_socket_path();
+    std::string data_dir = "data";
+    std::string data_file = "input.dat";
+    size_t clients = 4;
+    size_t requests = 100;
+    std::vector<int> days;
+    for (int ii=1; ii<argc; ii++) {
+        std::string_view arg = argv[ii];
+        if (arg == "-s" && ii+1 < argc) {
+            path = argv[++ii];
+        }
+        else if (arg == "-c" && ii+1 < argc) {
+            clients = std::max<size_t>(1, std::strtoull(argv[++ii], nullptr, 10));
+        }
+        else if (arg == "-n" && ii+1 < argc) {
+            requests = std::max<size_t>(1, std::strtoull(argv[++ii], nullptr, 10));
+        }
+        else if (arg == "-e") {
+            data_file = "example.dat";
+        }
+        else if (arg == "-d" && ii+1 < argc) {
+            data_dir = argv[++ii];
+        }
+        else if (int day = std::atoi(argv[ii]); day > 0) {
+            days.push_back(day);
+        }
+        else {
+            usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    auto input_path = [&](int day) {
+        return data_dir + "/day" + std::to_string(day) + "/" + data_file;
+    };
+    if (days.empty()) {
+        for (int day=1; day<=25; day++) {
+            if (std::filesystem::exists(input_path(day))) days.push_back(day);
+        }
+    }
+    std::vector<Job> jobs;
+    try {
+        for (int day : days) {
+            jobs.push_back({day, input_path(day), aoc::MappedFile(input_path(day))});
+        }
+    }
+    catch (const std::exception& err) {
+        std::cout << "Error: " << err.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (jobs.empty()) {
+        std::cout << "No inputs found in " << data_dir << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Every client runs its share of requests on its own connection, starting
+    // at a different day so the days are mixed at any moment
+    using Clock = std::chrono::steady_clock;
+    std::mutex mutex;
+    std::vector<Sample> samples;
+    std::map<int, std::string> answers;
+    size_t failures = 0;
+    Clock::time_point start = Clock::now();
+    std::vector<std::thread> threads;
+    for (size_t client=0; client<clients; client++) {
+        threads.emplace_back([&, client] {
+            std::vector<Sample> local;
+            local.reserve(requests);
+            size_t local_failures = 0;
+            int fd = -1;
+            try {
+                fd = protocol::connect_to(path);
+            }
+            catch (const std::exception& err) {
+                std::lock_guard<std::mutex> lock(mutex);
+                std::cout << "Error: " << err.what() << std::endl;
+                failures += requests;
+                return;
+            }
+            std::string text;
+            for (size_t ii=0; ii<requests; ii++) {
+                const Job& job = jobs[(client + ii) % jobs.size()];
+                Clock::time_point sent = Clock::now();
+                protocol::ResponseHeader header;
+                if (!protocol::send_request(fd, static_cast<uint32_t>(job.day), job.input.view()) ||
+                    !protocol::read_response(fd, header, text)) {
+                    local_failures += requests - ii;
+                    break;
+                }
+                int64_t round_trip = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sent).count();
+                local.push_back({job.day, round_trip, static_cast<int64_t>(header.server_ns)});
+                std::lock_guard<std::mutex> lock(mutex);
+                auto [expected, first] = answers.try_emplace(job.day, text);
+                if (header.status != protocol::Status::ok || expected->second != text) local_failures++;
+            }
+            ::close(fd);
+            std::lock_guard<std::mutex> lock(mutex);
+            samples.insert(samples.end(), local.begin(), local.end());
+            failures += local_failures;
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    // Report
+    if (samples.empty()) {
+        std::cout << "No request succeeded" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << samples.size() << " requests from " << clients << " clients in "
+              << std::fixed << std::setprecision(3) << elapsed.count() << " s, "
+              << std::setprecision(1) << static_cast<double>(samples.size()) / elapsed.count() << " requests/s\n\n";
+    std::cout << std::left << std::setw(8) << "day" << std::right << std::setw(10) << "requests"
+              << std::setw(12) << "min us" << std::setw(12) << "p50 us" << std::setw(12) << "p90 us"
+              << std::setw(12) << "p99 us" << std::setw(12) << "max us" << std::setw(14) << "server p50" << "\n";
+    std::vector<int64_t> all_round_trips, all_server;
+    for (const Job& job : jobs) {
+        std::vector<int64_t> round_trips, server;
+        for (const Sample& sample : samples) {
+            if (sample.day != job.day) continue;
+            round_trips.push_back(sample.round_trip_ns);
+            server.push_back(sample.server_ns);
+        }
+        if (round_trips.empty()) continue;
+        print_row(std::cout, "day" + std::to_string(job.day), round_trips, server);
+        all_round_trips.insert(all_round_trips.end(), round_trips.begin(), round_trips.end());
+        all_server.insert(all_server.end(), server.begin(), server.end());
+    }
+    print_row(std::cout, "all", all_round_trips, all_server);
+    std::cout << std::flush;
+
+    if (failures > 0) {
+        std::cout << "\n" << failures << " request(s) failed or gave inconsistent answers" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+// Solver daemon, answers (day, input) requests over a Unix domain socket
+//
+// Usage: aocd [-s socket] [-j threads] [-v]
+//
+// Every day is linked in and the solver threads are started up front, so a
+// request pays none of the exec, dynamic loading and iostream setup of
+// running a day's executable. Each connection gets its own thread that reads
+// requests into a buffer it keeps for the life of the connection, hands them
+// to the shared pool and writes the answers back in order, so any number of
+// clients can be connected at once. See aoc/protocol.h for the wire format and
+// tools/aoc_client.cc and tools/aoc_load.cc for clients.
+//
+// Each response carries the time the request took in the daemon. With -v every
+// request is also logged. SIGINT or SIGTERM stops the daemon, which then
+// prints the latency per day and removes the socket. The result cache is used
+// when AOC_CACHE_DIR is set, as in the other executables.
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "aoc/bench.h"
+#include "aoc/cache.h"
+#include "aoc/day.h"
+#include "aoc/parallel.h"
+#include "aoc/protocol.h"
+#include "aoc/registry.h"
+
+namespace protocol = aoc::protocol;
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int) {
+    stop_requested = 1;
+}
+
+struct Solved {
+    protocol::Status status;
+    std::string text;
+};
+
+Solved solve_request(uint32_t day_number, std::string_view input, const aoc::cache::Cache& cache) {
+    const aoc::Day* day = aoc::find_day(static_cast<int>(day_number));
+    if (day == nullptr) {
+        return {protocol::Status::unknown_day, "Unknown day " + std::to_string(day_number) + "\n"};
+    }
+    std::ostringstream out;
+    try {
+        aoc::bench::Harness bench(day->name, "request");
+        aoc::Answers answers = aoc::solve_cached(*day, input, bench, cache);
+        aoc::write_answers(*day, answers, out);
+    }
+    catch (const std::exception& err) {
+        return {protocol::Status::error, std::string("Error: ") + err.what() + "\n"};
+    }
+    return {protocol::Status::ok, out.str()};
+}
+
+class Server {
+public:
+    // Requests are solved on the shared pool, which the days' own parallel
+    // loops use too. Its size counts a calling thread, which here only
+    // waits, so it gets one more than the solver threads.
+    Server(size_t threads, bool verbose) : verbose_(verbose) {
+        aoc::parallel::init_pool((threads ? threads : aoc::parallel::default_threads()) + 1);
+    }
+
+    size_t threads() const { return aoc::parallel::pool().size() - 1; }
+
+    // Serves one client until it disconnects, the caller closes fd
+    void serve(int fd) {
+        using Clock = std::chrono::steady_clock;
+        std::string input;
+        input.reserve(1 << 20);
+        while (true) {
+            protocol::RequestHeader header;
+            if (!protocol::read_all(fd, &header, sizeof(header))) break;
+            Clock::time_point start = Clock::now();
+            if (header.magic != protocol::REQUEST_MAGIC || header.size > protocol::MAX_INPUT_SIZE) {
+                protocol::send_response(fd, protocol::Status::bad_request, 0, "Bad request\n");
+                break;
+            }
+            if (!protocol::read_payload(fd, header.size, input)) break;
+            Solved solved = aoc::parallel::pool().submit([&] { return solve_request(header.day, input, cache_); }).get();
+            int64_t elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+            record(header.day, header.size, solved.status, elapsed);
+            if (!protocol::send_response(fd, solved.status, static_cast<uint64_t>(elapsed), solved.text)) break;
+        }
+    }
+
+    // Prints min / median / p99 request latency per day
+    void report(std::ostream& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        out << std::left << std::setw(8) << "day" << std::right << std::setw(10) << "requests"
+            << std::setw(16) << "min us" << std::setw(16) << "median us" << std::setw(16) << "p99 us" << "\n";
+        for (auto& [day, samples] : latencies_) {
+            aoc::bench::PhaseStats stats = aoc::bench::summarize("day" + std::to_string(day), samples);
+            out << std::left << std::setw(8) << stats.name << std::right << std::setw(10) << stats.iterations
+                << std::fixed << std::setprecision(1)
+                << std::setw(16) << static_cast<double>(stats.min_ns) / 1e3
+                << std::setw(16) << static_cast<double>(stats.median_ns) / 1e3
+                << std::setw(16) << static_cast<double>(stats.p99_ns) / 1e3 << "\n";
+        }
+        out << std::flush;
+    }
+
+private:
+    void record(uint32_t day, uint64_t size, protocol::Status status, int64_t elapsed_ns) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latencies_[day].push_back(elapsed_ns);
+        if (verbose_) {
+            std::cout << "day" << day << " " << size << " bytes status " << static_cast<uint32_t>(status)
+                      << " " << std::fixed << std::setprecision(1) << static_cast<double>(elapsed_ns) / 1e3 << " us" << std::endl;
+        }
+    }
+
+    aoc::cache::Cache cache_;
+    bool verbose_;
+    std::mutex mutex_;
+    std::map<uint32_t, std::vector<int64_t>> latencies_;
+};
+
+void usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [-s socket] [-j threads] [-v]\n"
+              << "  -s socket   Socket to listen on (default: $AOC_SOCKET or " << protocol::default_socket_path() << ")\n"
+              << "  -j threads  Solver threads (default: one per core)\n"
+              << "  -v          Log every request\n";
+}
+
+int main(int argc, char **argv) {
+
+    // Check inputs
+    std::string path = protocol::default_socket_path();
+    size_t threads = 0;
+    bool verbose = false;
+    for (int ii=1; ii<argc; ii++) {
+        std::string_view arg = argv[ii];
+        if (arg == "-s" && ii+1 < argc) {
+            path = argv[++ii];
+        }
+        else if (arg == "-j" && ii+1 < argc) {
+            threads = std::strtoull(argv[++ii], nullptr, 10);
+        }
+        else if (arg == "-v") {
+            verbose = true;
+        }
+        else {
+            usage(argv[0]);
+            return arg == "-h" || arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    // Listen, replacing a socket left behind by a daemon that did not exit
+    // cleanly but not one that is still answering
+    sockaddr_un addr = protocol::socket_address(path);
+    try {
+        ::close(protocol::connect_to(path));
+        std::cout << "A daemon is already listening on " << path << std::endl;
+        return EXIT_FAILURE;
+    }
+    catch (const std::system_error&) {}
+    ::unlink(path.c_str());
+    int listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0 ||
+        ::bind(listen_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd, SOMAXCONN) != 0) {
+        std::cout << "Could not listen on " << path << ": " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::signal(SIGINT, request_stop);
+    std::signal(SIGTERM, request_stop);
+
+    Server server(threads, verbose);
+    std::cout << "Listening on " << path << " with " << server.threads() << " solver threads" << std::endl;
+
+    // Accept until asked to stop, polling so the stop flag is seen promptly.
+    // Connection threads are detached and tracked by their sockets, which
+    // are closed under the lock so a reused descriptor is never confused
+    // with the connection that had it before.
+    std::mutex clients_mutex;
+    std::condition_variable clients_done;
+    std::set<int> clients;
+    while (!stop_requested) {
+        pollfd pfd = {listen_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) <= 0) continue;
+        int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) continue;
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            clients.insert(fd);
+        }
+        std::thread([&server, &clients_mutex, &clients_done, &clients, fd] {
+            server.serve(fd);
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            clients.erase(fd);
+            ::close(fd);
+            clients_done.notify_all();
+        }).detach();
+    }
+
+    // Wake up every connection still waiting on its client, then wait for
+    // the requests in flight to finish
+    ::close(listen_fd);
+    ::unlink(path.c_str());
+    {
+        std::unique_lock<std::mutex> lock(clients_mutex);
+        for (int fd : clients) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        clients_done.wait(lock, [&clients] { return clients.empty(); });
+    }
+    std::cout << "\n";
+    server.report(std::cout);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+// Compares benchmark results against a baseline and refreshes the README
+//
+// Usage: bench_check [-t percent] [-m min_ns] [-r README.md] <baseline.json> <results.json>
+//
+// Both files are the combined JSON written by make bench. Every phase in the
+// results is matched to the same day and phase in the baseline, and the run
+// fails when a median is more than percent (default 10) slower than the
+// baseline and the difference is at least min_ns (default 10000), which keeps
+// noise on the very short phases from tripping it. New phases are reported but
+// never fail.
+//
+// With -r the results table in the README, between the results:begin and
+// results:end markers, is rewritten with each day's time taken as the sum of
+// its phase medians. The star columns are kept from the existing table.
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+struct Phase {
+    std::string name;
+    int64_t median_ns;
+};
+
+struct DayResult {
+    std::string day;
+    std::vector<Phase> phases;
+};
+
+bool read_file(const std::string& fname, std::string& contents) {
+    std::ifstream ifile(fname);
+    if (!ifile) return false;
+    std::stringstream buffer;
+    buffer << ifile.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+// Finds "key": after pos and returns the position just past it
+size_t find_key(std::string_view text, std::string_view key, size_t pos) {
+    std::string quoted = "\"";
+    quoted += key;
+    quoted += "\":";
+    size_t found = text.find(quoted, pos);
+    return found == std::string_view::npos ? found : found + quoted.size();
+}
+
+std::string_view read_string(std::string_view text, size_t& pos) {
+    size_t begin = text.find('"', pos) + 1;
+    size_t end = text.find('"', begin);
+    pos = end + 1;
+    return text.substr(begin, end - begin);
+}
+
+int64_t read_number(std::string_view text, size_t& pos) {
+    while (pos < text.size() && text[pos] == ' ') pos++;
+    size_t end = pos;
+    while (end < text.size() && (text[end] == '-' || (text[end] >= '0' && text[end] <= '9'))) end++;
+    int64_t value = std::strtoll(std::string(text.substr(pos, end - pos)).c_str(), nullptr, 10);
+    pos = end;
+    return value;
+}
+
+// Only understands the layout Harness::write_json produces, which is all
+// this needs to read
+std::vector<DayResult> parse_results(std::string_view text) {
+    std::vector<DayResult> days;
+    size_t pos = find_key(text, "day", 0);
+    while (pos != std::string_view::npos) {
+        DayResult result;
+        result.day = read_string(text, pos);
+        size_t next_day = find_key(text, "day", pos);
+        size_t phase = find_key(text, "name", pos);
+        while (phase != std::string_view::npos && phase < next_day) {
+            Phase info;
+            info.name = read_string(text, phase);
+            phase = find_key(text, "median_ns", phase);
+            info.median_ns = read_number(text, phase);
+            result.phases.push_back(info);
+            phase = find_key(text, "name", phase);
+        }
+        days.push_back(result);
+        pos = next_day;
+    }
+    return days;
+}
+
+std::string format_ms(int64_t ns) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << static_cast<double>(ns) / 1e6 << " ms";
+    return out.str();
+}
+
+bool update_readme(const std::string& fname, const std::vector<DayResult>& results) {
+    const std::string begin_marker = "<!-- results:begin -->";
+    const std::string end_marker = "<!-- results:end -->";
+    std::string readme;
+    if (!read_file(fname, readme)) {
+        std::cout << "Could not read " << fname << std::endl;
+        return false;
+    }
+    size_t begin = readme.find(begin_marker);
+    size_t end = readme.find(end_marker);
+    if (begin == std::string::npos || end == std::string::npos || end < begin) {
+        std::cout << "No results markers in " << fname << std::endl;
+        return false;
+    }
+    begin += begin_marker.size();
+
+    // Keep the stars from the current table, keyed by day number
+    std::map<std::string, std::pair<std::string, std::string>> stars;
+    std::istringstream table(readme.substr(begin, end - begin));
+    std::string line;
+    while (std::getline(table, line)) {
+        std::vector<std::string> cells;
+        std::istringstream row(line);
+        std::string cell;
+        while (std::getline(row, cell, '|')) {
+            size_t first = cell.find_first_not_of(' ');
+            size_t last = cell.find_last_not_of(' ');
+            cells.push_back(first == std::string::npos ? "" : cell.substr(first, last - first + 1));
+        }
+        if (cells.size() >= 4 && !cells[1].empty() && cells[1][0] >= '0' && cells[1][0] <= '9') {
+            stars[cells[1]] = {cells[2], cells[3]};
+        }
+    }
+
+    std::ostringstream out;
+    out << "\n| Day | Part 1 | Part 2           | Time         |\n";
+    out << "| --- | ------ | ---------------- | ------------ |\n";
+    for (const DayResult& result : results) {
+        std::string number = result.day.substr(result.day.find_first_of("0123456789"));
+        int64_t total = 0;
+        for (const Phase& phase : result.phases) {
+            total += phase.median_ns;
+        }
+        std::pair<std::string, std::string> day_stars = stars.contains(number) ? stars[number] : std::make_pair(std::string(""), std::string(""));
+        out << "| " << std::left << std::setw(3) << number
+            << " | " << std::setw(6) << day_stars.first
+            << " | " << std::setw(16) << day_stars.second
+            << " | " << std::setw(12) << format_ms(total) << " |\n";
+    }
+    readme.replace(begin, end - begin, out.str());
+
+    std::ofstream ofile(fname);
+    ofile << readme;
+    return true;
+}
+
+int main(int argc, char **argv) {
+
+    // Check inputs
+    double threshold = 10.0;
+    int64_t min_ns = 10000;
+    std::string readme;
+    std::vector<std::string> files;
+    for (int ii=1; ii<argc; ii++) {
+        std::string_view arg = argv[ii];
+        if (arg == "-t" && ii+1 < argc) {
+            threshold = std::strtod(argv[++ii], nullptr);
+        }
+        else if (arg == "-m" && ii+1 < argc) {
+            min_ns = std::strtoll(argv[++ii], nullptr, 10);
+        }
+        else if (arg == "-r" && ii+1 < argc) {
+            readme = argv[++ii];
+        }
+        else {
+            files.push_back(argv[ii]);
+        }
+    }
+    if (files.size() != 2) {
+        std::cout << "Usage: " << argv[0] << " [-t percent] [-m min_ns] [-r README.md] <baseline.json> <results.json>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string baseline_text, results_text;
+    if (!read_file(files[0], baseline_text) || !read_file(files[1], results_text)) {
+        std::cout << "Could not read " << files[0] << " or " << files[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::vector<DayResult> baseline = parse_results(baseline_text);
+    std::vector<DayResult> results = parse_results(results_text);
+
+    // Index the baseline by day and phase
+    std::map<std::pair<std::string, std::string>, int64_t> baseline_medians;
+    for (const DayResult& result : baseline) {
+        for (const Phase& phase : result.phases) {
+            baseline_medians[{result.day, phase.name}] = phase.median_ns;
+        }
+    }
+
+    // Compare every phase
+    size_t regressions = 0;
+    std::cout << std::left << std::setw(8) << "day" << std::setw(36) << "phase"
+              << std::right << std::setw(16) << "baseline" << std::setw(16) << "current"
+              << std::setw(10) << "change" << "\n";
+    for (const DayResult& result : results) {
+        for (const Phase& phase : result.phases) {
+            std::cout << std::left << std::setw(8) << result.day << std::setw(36) << phase.name << std::right;
+            auto found = baseline_medians.find({result.day, phase.name});
+            if (found == baseline_medians.end()) {
+                std::cout << std::setw(16) << "-" << std::setw(16) << format_ms(phase.median_ns)
+                          << std::setw(10) << "new" << "\n";
+                continue;
+            }
+            int64_t base = found->second;
+            double change = base > 0 ? 100.0 * static_cast<double>(phase.median_ns - base) / static_cast<double>(base) : 0.0;
+            bool regressed = change > threshold && phase.median_ns - base >= min_ns;
+            std::ostringstream change_str;
+            change_str << std::showpos << std::fixed << std::setprecision(1) << change << "%";
+            std::cout << std::setw(16) << format_ms(base) << std::setw(16) << format_ms(phase.median_ns)
+                      << std::setw(10) << change_str.str() << (regressed ? "  REGRESSED" : "") << "\n";
+            if (regressed) regressions++;
+        }
+    }
+
+    // Refresh the README table from the measured numbers
+    if (!readme.empty() && !update_readme(readme, results)) {
+        return EXIT_FAILURE;
+    }
+
+    if (regressions > 0) {
+        std::cout << "\n" << regressions << " phase(s) regressed by more than " << threshold << "%" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "\nNo phase regressed by more than " << threshold << "%" << std::endl;
+    return EXIT_SUCCESS;
+}
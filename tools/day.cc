@@ -0,0 +1,28 @@
+// Standalone executable for a single day
+//
+// Built once per day with -DAOC_DAY_NAME=dayN and linked against just that day
+// from libaoc.a.
+#include "aoc/day.h"
+#include "aoc/memstats_hooks.h"
+#include "aoc/sampler.h"
+
+#ifndef AOC_DAY_NAME
+#error "AOC_DAY_NAME must be defined as the day's namespace, e.g. -DAOC_DAY_NAME=day1"
+#endif
+
+namespace AOC_DAY_NAME { extern const aoc::Day day; }
+
+#ifdef AOC_EMBED
+// Generated from data/dayN by tools/embed.cc, e.g. "aoc/embedded/day1.h"
+#define AOC_STRINGIFY(x) #x
+#define AOC_EMBED_HEADER(name) AOC_STRINGIFY(aoc/embedded/name.h)
+#include AOC_EMBED_HEADER(AOC_DAY_NAME)
+
+int main(int argc, char **argv) {
+    return aoc::embedded_main(AOC_DAY_NAME::day, AOC_DAY_NAME::embedded::input, AOC_DAY_NAME::embedded::example, argc, argv);
+}
+#else
+int main(int argc, char **argv) {
+    return aoc::day_main(AOC_DAY_NAME::day, argc, argv);
+}
+#endif
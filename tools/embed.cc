@@ -0,0 +1,80 @@
+// Turns a day's data files into a header that compiles them into the program
+//
+// Usage: embed <namespace> <output.h> <name>=<file> ...
+//
+// For every name the header defines, inside namespace <namespace>::embedded,
+//   name      the file's bytes as a constexpr std::string_view
+//   has_name  false when the file did not exist, name is then empty
+// so a missing data file leaves a build that still compiles. The output is
+// only rewritten when it changes, which keeps make from rebuilding everything
+// that includes it.
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+bool read_file(const std::string& fname, std::string& contents) {
+    std::ifstream ifile(fname, std::ios::binary);
+    if (!ifile) return false;
+    std::stringstream buffer;
+    buffer << ifile.rdbuf();
+    contents = buffer.str();
+    return true;
+}
+
+// Writes the bytes as an array rather than a string literal, which has no
+// escaping rules to get wrong and no length limit
+void write_array(std::ostream& out, const std::string& name, const std::string& contents) {
+    out << "inline constexpr char " << name << "_bytes[] = {";
+    for (size_t ii=0; ii<contents.size(); ii++) {
+        out << (ii % 16 == 0 ? "\n    " : " ") << static_cast<int>(static_cast<unsigned char>(contents[ii])) << ",";
+    }
+    out << "\n    0,\n};\n";
+}
+
+int main(int argc, char **argv) {
+
+    // Check inputs
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <namespace> <output.h> <name>=<file> ..." << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::string ns = argv[1];
+    std::string output = argv[2];
+
+    std::ostringstream out;
+    out << "// Generated by tools/embed.cc, do not edit\n"
+        << "#pragma once\n\n"
+        << "#include <string_view>\n\n"
+        << "namespace " << ns << "::embedded {\n";
+    for (int ii=3; ii<argc; ii++) {
+        std::string_view arg = argv[ii];
+        size_t eq = arg.find('=');
+        if (eq == std::string_view::npos) {
+            std::cout << "Expected <name>=<file>, got " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::string name(arg.substr(0, eq));
+        std::string contents;
+        bool found = read_file(std::string(arg.substr(eq + 1)), contents);
+        out << "\n";
+        write_array(out, name, contents);
+        out << "inline constexpr std::string_view " << name << "{" << name << "_bytes, " << contents.size() << "};\n"
+            << "inline constexpr bool has_" << name << " = " << (found ? "true" : "false") << ";\n";
+    }
+    out << "\n} // namespace " << ns << "::embedded\n";
+
+    std::string existing;
+    if (read_file(output, existing) && existing == out.str()) {
+        return EXIT_SUCCESS;
+    }
+    std::ofstream ofile(output, std::ios::binary);
+    ofile << out.str();
+    if (!ofile) {
+        std::cout << "Could not write " << output << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
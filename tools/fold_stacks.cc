@@ -0,0 +1,326 @@
+// Folds sampled call stacks for flame graphs
+//
+// Usage: fold_stacks [-s svg] [-t title] -e <executable> <samples>
+//        perf script | fold_stacks [-s svg] [-t title] -p
+//
+// Prints one line per distinct stack, root first, with its frames separated
+// by ';' and followed by the number of samples, which is what flame graph
+// tools read. -e takes the samples aoc/sampler.h wrote for the executable and
+// looks its addresses up with addr2line, with every function inlined at an
+// address as a frame of its own. -p takes the text perf script prints for a
+// perf record -g. Parameter lists are dropped from the function names. -s
+// also draws the flame graph into an SVG file, wider frames for more samples
+// and callers below callees, with the full name and counts in a tooltip.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+using Stack = std::vector<std::string>;
+using Folded = std::map<Stack, size_t>;
+
+// The name without its parameter list, and without ';' which separates frames
+std::string clean_name(std::string name) {
+    std::string_view view = name;
+    if (view.ends_with(" const")) view.remove_suffix(6);
+    if (view.ends_with(')')) {
+        int depth = 0;
+        for (size_t ii=view.size(); ii-->0;) {
+            if (view[ii] == ')') depth++;
+            if (view[ii] == '(' && --depth == 0) {
+                // Not when the name is all parameters, like "(anonymous namespace)"
+                if (ii > 0) view = view.substr(0, ii);
+                break;
+            }
+        }
+    }
+    name = view;
+    std::replace(name.begin(), name.end(), ';', ':');
+    return name;
+}
+
+std::string demangle(const std::string& symbol) {
+    int status = 0;
+    std::unique_ptr<char, decltype(&std::free)> name(abi::__cxa_demangle(symbol.c_str(), nullptr, nullptr, &status), std::free);
+    return status == 0 ? std::string(name.get()) : symbol;
+}
+
+// Frames of each address in the executable, innermost first
+std::map<std::string, Stack> symbolize(const std::string& executable, const std::vector<std::string>& addresses) {
+    std::map<std::string, Stack> frames;
+    if (addresses.empty()) return frames;
+
+    char list[] = "/tmp/fold_stacks-XXXXXX";
+    int fd = mkstemp(list);
+    if (fd < 0) return frames;
+    std::string text;
+    for (const std::string& address : addresses) {
+        text += address + "\n";
+    }
+    bool written = write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+    close(fd);
+
+    // With -a every address comes first, followed by a function and location
+    // line for it and for each function it is inlined into
+    if (written) {
+        std::string command = "addr2line -a -f -i -C -e '" + executable + "' < " + list;
+        if (FILE* pipe = popen(command.c_str(), "r")) {
+            std::string current;
+            bool function = true;
+            char line[8192];
+            while (std::fgets(line, sizeof(line), pipe)) {
+                std::string_view view = line;
+                if (view.ends_with('\n')) view.remove_suffix(1);
+                if (view.starts_with("0x")) {
+                    current = std::to_string(std::strtoull(std::string(view).c_str(), nullptr, 16));
+                    function = true;
+                    continue;
+                }
+                if (function && !current.empty()) frames[current].push_back(view == "??" ? "[unknown]" : clean_name(std::string(view)));
+                function = !function;
+            }
+            pclose(pipe);
+        }
+    }
+    unlink(list);
+    return frames;
+}
+
+// Samples written by aoc/sampler.h
+bool read_samples(const std::string& executable, const std::string& fname, Folded& folded) {
+    std::ifstream ifile(fname);
+    if (!ifile) return false;
+    std::vector<std::vector<std::string>> samples;
+    std::vector<std::string> addresses;
+    std::string line;
+    while (std::getline(ifile, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream tokens(line);
+        std::vector<std::string>& sample = samples.emplace_back();
+        std::string token;
+        while (tokens >> token) {
+            if (token.starts_with("0x")) addresses.push_back(token);
+            sample.push_back(token);
+        }
+    }
+    std::sort(addresses.begin(), addresses.end());
+    addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+    // Keyed by value, as addr2line pads the addresses it echoes
+    std::map<std::string, Stack> frames = symbolize(executable, addresses);
+    for (const std::vector<std::string>& sample : samples) {
+        Stack stack;
+        for (const std::string& token : sample) {
+            if (token.starts_with("0x")) {
+                auto found = frames.find(std::to_string(std::strtoull(token.c_str(), nullptr, 16)));
+                if (found != frames.end() && !found->second.empty()) {
+                    stack.insert(stack.end(), found->second.begin(), found->second.end());
+                }
+                else {
+                    stack.push_back(token);
+                }
+                continue;
+            }
+            size_t colon = token.find(':');
+            if (colon == std::string::npos) stack.push_back("[" + token + "]");
+            else stack.push_back(clean_name(demangle(token.substr(colon + 1))));
+        }
+        std::reverse(stack.begin(), stack.end());
+        folded[stack]++;
+    }
+    return true;
+}
+
+// perf script output: a header line per sample, then one indented line per
+// frame, innermost first, of "address symbol[+offset] (library)"
+void read_perf(std::istream& in, Folded& folded) {
+    Stack stack;
+    auto finish = [&] {
+        if (stack.empty()) return;
+        std::reverse(stack.begin(), stack.end());
+        folded[stack]++;
+        stack.clear();
+    };
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            finish();
+            continue;
+        }
+        if (line[0] != ' ' && line[0] != '\t') {
+            finish();
+            continue;
+        }
+        std::string_view frame = line;
+        frame.remove_prefix(std::min(frame.size(), frame.find_first_not_of(" \t")));
+        frame.remove_prefix(std::min(frame.size(), frame.find(' ') + 1));
+        size_t library = frame.rfind(" (");
+        std::string_view dso;
+        if (library != std::string_view::npos && frame.ends_with(')')) {
+            dso = frame.substr(library + 2, frame.size() - library - 3);
+            frame = frame.substr(0, library);
+        }
+        size_t offset = frame.rfind("+0x");
+        if (offset != std::string_view::npos) frame = frame.substr(0, offset);
+        if (frame.empty() || frame == "[unknown]") {
+            std::string& name = stack.emplace_back("[");
+            name += dso.substr(dso.rfind('/') + 1);
+            name += "]";
+        }
+        else {
+            stack.push_back(clean_name(std::string(frame)));
+        }
+    }
+    finish();
+}
+
+struct Node {
+    size_t count = 0;
+    std::map<std::string, Node> children;
+};
+
+std::string escape(std::string_view text) {
+    std::string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '&': escaped += "&amp;"; break;
+            case '<': escaped += "&lt;"; break;
+            case '>': escaped += "&gt;"; break;
+            case '"': escaped += "&quot;"; break;
+            default: escaped += c;
+        }
+    }
+    return escaped;
+}
+
+size_t tree_depth(const Node& node) {
+    size_t depth = 0;
+    for (const auto& [name, child] : node.children) {
+        depth = std::max(depth, tree_depth(child) + 1);
+    }
+    return depth;
+}
+
+constexpr double SVG_WIDTH = 1200;
+constexpr double SVG_PAD = 10;
+constexpr double FRAME_HEIGHT = 16;
+constexpr double LABEL_CHAR_WIDTH = 7;
+
+// Draws node and everything above it, with x and the width in pixels
+void draw(std::ostream& out, const std::string& name, const Node& node, size_t total, double x, double width, size_t level, double bottom) {
+    if (width < 0.1) return;
+    double y = bottom - static_cast<double>(level + 1) * FRAME_HEIGHT;
+    // Warm colours, the same for a name every time
+    size_t hash = std::hash<std::string>{}(name);
+    int red = 205 + static_cast<int>(hash % 50);
+    int green = static_cast<int>((hash >> 8) % 230);
+    int blue = static_cast<int>((hash >> 16) % 55);
+    double percent = 100.0 * static_cast<double>(node.count) / static_cast<double>(total);
+    std::string label = name;
+    size_t fits = static_cast<size_t>(std::max(0.0, (width - 6) / LABEL_CHAR_WIDTH));
+    if (label.size() > fits) label = fits < 3 ? "" : label.substr(0, fits - 2) + "..";
+
+    char numbers[160];
+    std::snprintf(numbers, sizeof(numbers), "x=\"%.2f\" y=\"%.1f\" width=\"%.2f\" height=\"%.1f\"", x, y, width, FRAME_HEIGHT - 1);
+    out << "<g><title>" << escape(name) << " (" << node.count << " samples, " << std::fixed << std::setprecision(2)
+        << percent << "%)</title><rect " << numbers << " fill=\"rgb(" << red << "," << green << "," << blue << ")\" rx=\"2\"/>";
+    if (!label.empty()) {
+        std::snprintf(numbers, sizeof(numbers), "x=\"%.2f\" y=\"%.1f\"", x + 3, y + FRAME_HEIGHT - 4);
+        out << "<text " << numbers << ">" << escape(label) << "</text>";
+    }
+    out << "</g>\n";
+
+    double scale = width / static_cast<double>(node.count);
+    for (const auto& [child_name, child] : node.children) {
+        double child_width = static_cast<double>(child.count) * scale;
+        draw(out, child_name, child, total, x, child_width, level + 1, bottom);
+        x += child_width;
+    }
+}
+
+void write_svg(std::ostream& out, const Folded& folded, const std::string& title) {
+    Node root;
+    for (const auto& [stack, count] : folded) {
+        Node* node = &root;
+        node->count += count;
+        for (const std::string& frame : stack) {
+            node = &node->children[frame];
+            node->count += count;
+        }
+    }
+    size_t levels = tree_depth(root) + 1;
+    double height = static_cast<double>(levels) * FRAME_HEIGHT + 3 * SVG_PAD + FRAME_HEIGHT;
+    out << "<?xml version=\"1.0\" standalone=\"no\"?>\n"
+        << "<svg version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\" width=\"" << SVG_WIDTH << "\" height=\"" << height
+        << "\" viewBox=\"0 0 " << SVG_WIDTH << " " << height << "\" font-family=\"monospace\" font-size=\"11\">\n"
+        << "<rect width=\"100%\" height=\"100%\" fill=\"#f8f8f8\"/>\n"
+        << "<text x=\"" << SVG_WIDTH / 2 << "\" y=\"" << SVG_PAD + FRAME_HEIGHT - 4 << "\" text-anchor=\"middle\" font-size=\"15\">"
+        << escape(title) << " (" << root.count << " samples)</text>\n";
+    if (root.count > 0) {
+        draw(out, "all", root, root.count, SVG_PAD, SVG_WIDTH - 2 * SVG_PAD, 0, height - SVG_PAD);
+    }
+    out << "</svg>\n";
+}
+
+int main(int argc, char **argv) {
+
+    std::string svg_path;
+    std::string title = "Flame Graph";
+    std::string executable;
+    bool perf = false;
+    bool usage = false;
+    int opt;
+    while ((opt = getopt(argc, argv, "s:t:e:p")) != -1) {
+        switch (opt) {
+            case 's': svg_path = optarg; break;
+            case 't': title = optarg; break;
+            case 'e': executable = optarg; break;
+            case 'p': perf = true; break;
+            default: usage = true; break;
+        }
+    }
+    // Exactly one of -e with a samples file or -p
+    if (usage || perf == !executable.empty() || optind != argc - (perf ? 0 : 1)) {
+        std::cout << "Usage: " << argv[0] << " [-s svg] [-t title] -e <executable> <samples>\n"
+                  << "       perf script | " << argv[0] << " [-s svg] [-t title] -p" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    Folded folded;
+    if (perf) {
+        read_perf(std::cin, folded);
+    }
+    else if (!read_samples(executable, argv[optind], folded)) {
+        std::cout << "Unable to read " << argv[optind] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    for (const auto& [stack, count] : folded) {
+        for (size_t ii=0; ii<stack.size(); ii++) {
+            std::cout << (ii ? ";" : "") << stack[ii];
+        }
+        std::cout << " " << count << "\n";
+    }
+    if (!svg_path.empty()) {
+        std::ofstream ofile(svg_path);
+        write_svg(ofile, folded, title);
+        if (!ofile) {
+            std::cout << "Unable to write " << svg_path << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
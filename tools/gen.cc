@@ -0,0 +1,352 @@
+// Synthetic input generator for stress testing the days at scale
+//
+// Usage: gen <day> <size> [seed] [extra]
+//
+// Writes a valid puzzle input to stdout. What size (and extra) control depends
+// on the day:
+//   1   size turns
+//   2   size ranges, extra = max digits of the bounds (default 10)
+//   3   size battery banks, extra = digits per bank (default 100)
+//   4   size x size grid, extra = percent of cells with paper (default 65)
+//   5   size fresh ranges and 4 * size ingredients
+//   6   size problems of 4 numbers each
+//   7   size x size manifold, extra = percent of splitter slots used (default 30)
+//   8   size junction boxes
+//   9   size polygon vertices (rounded up to a multiple of 4)
+//   10  size machines, extra = lights per machine (default 6)
+//   11  size devices
+//   12  size regions
+// The same day, size, seed and extra always produce the same bytes.
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// mt19937_64 output is fully specified by the standard, unlike the standard
+// distributions, so ranges are derived from it directly to keep the inputs
+// identical on every platform
+class Random {
+public:
+    explicit Random(uint64_t seed) : engine_(seed) {}
+
+    // Uniform integer in [lo, hi]
+    int64_t range(int64_t lo, int64_t hi) {
+        return lo + static_cast<int64_t>(engine_() % static_cast<uint64_t>(hi - lo + 1));
+    }
+
+    bool chance(int percent) { return range(0, 99) < percent; }
+
+private:
+    std::mt19937_64 engine_;
+};
+
+void gen_day1(std::string& out, Random& rng, size_t size, int64_t) {
+    for (size_t ii=0; ii<size; ii++) {
+        out += rng.chance(50) ? 'L' : 'R';
+        out += std::to_string(rng.range(1, 999));
+        out += '\n';
+    }
+}
+
+int64_t pow10(int64_t exp) {
+    int64_t value = 1;
+    while (exp-- > 0) value *= 10;
+    return value;
+}
+
+void gen_day2(std::string& out, Random& rng, size_t size, int64_t extra) {
+    int64_t max_digits = extra > 0 ? std::min<int64_t>(extra, 18) : 10;
+    for (size_t ii=0; ii<size; ii++) {
+        int64_t digits = rng.range(1, max_digits);
+        int64_t lower = rng.range(pow10(digits - 1), pow10(digits) - 1);
+        int64_t upper = lower + rng.range(0, std::max<int64_t>(1, lower / 1000));
+        if (ii) out += ',';
+        out += std::to_string(lower) + "-" + std::to_string(upper);
+    }
+    out += '\n';
+}
+
+void gen_day3(std::string& out, Random& rng, size_t size, int64_t extra) {
+    int64_t width = extra > 0 ? std::max<int64_t>(extra, 12) : 100;
+    for (size_t ii=0; ii<size; ii++) {
+        for (int64_t jj=0; jj<width; jj++) {
+            out += static_cast<char>('0' + rng.range(1, 9));
+        }
+        out += '\n';
+    }
+}
+
+void gen_day4(std::string& out, Random& rng, size_t size, int64_t extra) {
+    int percent = extra > 0 ? static_cast<int>(extra) : 65;
+    for (size_t row=0; row<size; row++) {
+        for (size_t col=0; col<size; col++) {
+            out += rng.chance(percent) ? '@' : '.';
+        }
+        out += '\n';
+    }
+}
+
+void gen_day5(std::string& out, Random& rng, size_t size, int64_t) {
+    const int64_t span = 1000000000000000;
+    for (size_t ii=0; ii<size; ii++) {
+        int64_t begin = rng.range(1, span);
+        int64_t end = begin + rng.range(0, span / static_cast<int64_t>(size * 4));
+        out += std::to_string(begin) + "-" + std::to_string(end) + "\n";
+    }
+    out += '\n';
+    for (size_t ii=0; ii<size*4; ii++) {
+        out += std::to_string(rng.range(1, span)) + "\n";
+    }
+}
+
+void gen_day6(std::string& out, Random& rng, size_t size, int64_t) {
+    // Numbers are aligned left or right within each problem's column so the
+    // cephalopod reading has gaps to deal with
+    const size_t rows = 4;
+    std::vector<std::string> lines(rows + 1);
+    for (size_t prob=0; prob<size; prob++) {
+        int64_t width = rng.range(1, 4);
+        bool align_left = rng.chance(50);
+        for (size_t row=0; row<rows; row++) {
+            std::string number = std::to_string(rng.range(1, pow10(rng.range(1, width)) - 1));
+            std::string pad(static_cast<size_t>(width) - number.size(), ' ');
+            if (prob) lines[row] += ' ';
+            lines[row] += align_left ? number + pad : pad + number;
+        }
+        if (prob) lines[rows] += ' ';
+        lines[rows] += rng.chance(50) ? '+' : '*';
+        lines[rows] += std::string(static_cast<size_t>(width) - 1, ' ');
+    }
+    for (const std::string& line : lines) {
+        out += line + "\n";
+    }
+}
+
+void gen_day7(std::string& out, Random& rng, size_t size, int64_t extra) {
+    // Splitters only go on even rows and never in the outer columns, which
+    // is the shape of the real puzzle input
+    int percent = extra > 0 ? static_cast<int>(extra) : 30;
+    size_t width = std::max<size_t>(size | 1, 3);
+    size_t start = width / 2;
+    for (size_t row=0; row<size; row++) {
+        std::string line(width, '.');
+        if (row == 0) {
+            line[start] = 'S';
+        }
+        else if (row % 2 == 0) {
+            size_t reach = std::min(row / 2, start - 1);
+            for (size_t col=start-reach; col<=start+reach; col++) {
+                if (rng.chance(percent)) line[col] = '^';
+            }
+        }
+        out += line + "\n";
+    }
+}
+
+void gen_day8(std::string& out, Random& rng, size_t size, int64_t) {
+    for (size_t ii=0; ii<size; ii++) {
+        out += std::to_string(rng.range(0, 99999)) + ","
+             + std::to_string(rng.range(0, 99999)) + ","
+             + std::to_string(rng.range(0, 99999)) + "\n";
+    }
+}
+
+void gen_day9(std::string& out, Random& rng, size_t size, int64_t) {
+    // An x-monotone rectilinear polygon: a staircase along the top from left
+    // to right and another along the bottom back again. Every top step stays
+    // above every bottom step, so the outline never crosses itself.
+    size_t columns = std::max<size_t>((size + 3) / 4, 2);
+    std::vector<int64_t> xs;
+    int64_t x = rng.range(1, 100);
+    for (size_t ii=0; ii<=columns; ii++) {
+        xs.push_back(x);
+        x += rng.range(1, 200);
+    }
+    const int64_t mid = 100000;
+    std::vector<int64_t> top(columns), bottom(columns);
+    for (size_t ii=0; ii<columns; ii++) {
+        do {
+            top[ii] = rng.range(mid + 1, 2 * mid);
+        } while (ii && top[ii] == top[ii-1]);
+        do {
+            bottom[ii] = rng.range(1, mid - 1);
+        } while (ii && bottom[ii] == bottom[ii-1]);
+    }
+    auto vertex = [&out](int64_t vx, int64_t vy) {
+        out += std::to_string(vx) + "," + std::to_string(vy) + "\n";
+    };
+    for (size_t ii=0; ii<columns; ii++) {
+        vertex(xs[ii], top[ii]);
+        vertex(xs[ii+1], top[ii]);
+    }
+    for (size_t ii=columns; ii>0; ii--) {
+        vertex(xs[ii], bottom[ii-1]);
+        vertex(xs[ii-1], bottom[ii-1]);
+    }
+}
+
+void gen_day10(std::string& out, Random& rng, size_t size, int64_t extra) {
+    // The targets are built from random button presses so every machine is
+    // guaranteed to have a solution for both parts
+    int64_t lights = extra > 0 ? std::min<int64_t>(extra, 16) : 6;
+    for (size_t machine=0; machine<size; machine++) {
+        int64_t num_buttons = rng.range(lights, lights + 3);
+        std::vector<uint32_t> buttons;
+        uint32_t covered = 0;
+        for (int64_t bb=0; bb<num_buttons; bb++) {
+            uint32_t wires = 0;
+            int64_t count = rng.range(1, std::min<int64_t>(lights, 4));
+            for (int64_t ww=0; ww<count; ww++) {
+                wires |= 1u << rng.range(0, lights - 1);
+            }
+            buttons.push_back(wires);
+            covered |= wires;
+        }
+        for (int64_t light=0; light<lights; light++) {
+            if (!(covered & (1u << light))) {
+                buttons[static_cast<size_t>(rng.range(0, num_buttons - 1))] |= 1u << light;
+            }
+        }
+
+        uint32_t indicator = 0;
+        while (indicator == 0) {
+            for (uint32_t wires : buttons) {
+                if (rng.chance(50)) indicator ^= wires;
+            }
+        }
+        std::vector<int64_t> joltage(static_cast<size_t>(lights), 0);
+        for (uint32_t wires : buttons) {
+            int64_t presses = rng.range(0, 8);
+            for (int64_t light=0; light<lights; light++) {
+                if (wires & (1u << light)) joltage[static_cast<size_t>(light)] += presses;
+            }
+        }
+
+        out += '[';
+        for (int64_t light=0; light<lights; light++) {
+            out += (indicator & (1u << light)) ? '#' : '.';
+        }
+        out += ']';
+        for (uint32_t wires : buttons) {
+            out += " (";
+            bool first = true;
+            for (int64_t light=0; light<lights; light++) {
+                if (!(wires & (1u << light))) continue;
+                if (!first) out += ',';
+                out += std::to_string(light);
+                first = false;
+            }
+            out += ')';
+        }
+        out += " {";
+        for (int64_t light=0; light<lights; light++) {
+            if (light) out += ',';
+            out += std::to_string(joltage[static_cast<size_t>(light)]);
+        }
+        out += "}\n";
+    }
+}
+
+void gen_day11(std::string& out, Random& rng, size_t size, int64_t) {
+    // A DAG in topological order: svr and you first, fft a third of the way
+    // in, dac two thirds in, and every device only feeds later devices or out
+    size_t count = std::max<size_t>(size, 8);
+    size_t name_len = count > 5000 ? 4 : 3;
+    std::vector<std::string> names;
+    std::vector<bool> used(size_t{1} << (5 * name_len), false);
+    auto fresh_name = [&]() {
+        while (true) {
+            std::string name;
+            size_t key = 0;
+            for (size_t ii=0; ii<name_len; ii++) {
+                int64_t letter = rng.range(0, 25);
+                name += static_cast<char>('a' + letter);
+                key = (key << 5) | static_cast<size_t>(letter);
+            }
+            if (name == "you" || name == "svr" || name == "fft" || name == "dac" || name == "out") continue;
+            if (used[key]) continue;
+            used[key] = true;
+            return name;
+        }
+    };
+    names.push_back("svr");
+    names.push_back("you");
+    for (size_t ii=2; ii<count; ii++) {
+        if (ii == count / 3) names.push_back("fft");
+        else if (ii == 2 * count / 3) names.push_back("dac");
+        else names.push_back(fresh_name());
+    }
+    for (size_t ii=0; ii<count; ii++) {
+        out += names[ii] + ":";
+        size_t remaining = count - ii - 1;
+        size_t fan_out = std::min<size_t>(remaining, static_cast<size_t>(rng.range(1, 3)));
+        // Keep the links local so the path counts stay interesting rather
+        // than collapsing onto a few hubs
+        for (size_t ff=0; ff<fan_out; ff++) {
+            size_t reach = std::min<size_t>(remaining, 20);
+            out += " " + names[ii + 1 + static_cast<size_t>(rng.range(0, static_cast<int64_t>(reach) - 1))];
+        }
+        if (remaining == 0 || rng.chance(10)) out += " out";
+        if (names[ii] == "svr") out += " fft";
+        if (names[ii] == "fft") out += " dac";
+        out += "\n";
+    }
+}
+
+void gen_day12(std::string& out, Random& rng, size_t size, int64_t) {
+    const char* shapes =
+        "0:\n###\n##.\n##.\n\n"
+        "1:\n###\n##.\n.##\n\n"
+        "2:\n.##\n###\n##.\n\n"
+        "3:\n##.\n###\n##.\n\n"
+        "4:\n###\n#..\n###\n\n"
+        "5:\n###\n.#.\n###\n\n";
+    out += shapes;
+    for (size_t ii=0; ii<size; ii++) {
+        int64_t width = rng.range(4, 50);
+        int64_t height = rng.range(4, 50);
+        out += std::to_string(width) + "x" + std::to_string(height) + ":";
+        int64_t budget = (width / 3) * (height / 3);
+        for (int shape=0; shape<6; shape++) {
+            out += ' ';
+            out += std::to_string(rng.range(0, std::max<int64_t>(1, budget / 4)));
+        }
+        out += "\n";
+    }
+}
+
+using Generator = void (*)(std::string&, Random&, size_t, int64_t);
+
+const std::vector<Generator> GENERATORS = {
+    gen_day1, gen_day2, gen_day3, gen_day4, gen_day5, gen_day6,
+    gen_day7, gen_day8, gen_day9, gen_day10, gen_day11, gen_day12,
+};
+
+int main(int argc, char **argv) {
+
+    // Check inputs
+    if (argc < 3 || argc > 5) {
+        std::cout << "Usage: " << argv[0] << " <day> <size> [seed] [extra]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    int day = std::atoi(argv[1]);
+    if (day < 1 || day > static_cast<int>(GENERATORS.size())) {
+        std::cout << "Day must be between 1 and " << GENERATORS.size() << std::endl;
+        return EXIT_FAILURE;
+    }
+    size_t size = std::strtoull(argv[2], nullptr, 10);
+    uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2025;
+    int64_t extra = argc > 4 ? std::strtoll(argv[4], nullptr, 10) : 0;
+
+    // Generate the input
+    Random rng(seed);
+    std::string out;
+    GENERATORS[static_cast<size_t>(day - 1)](out, rng, size, extra);
+    std::fwrite(out.data(), 1, out.size(), stdout);
+
+    return EXIT_SUCCESS;
+}